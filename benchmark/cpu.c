@@ -0,0 +1,896 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// Benchmark of the CPU side bezier library, results are written to stdout as JSON.
+//
+// Build (Linux): cc -O2 -mavx2 -mfma cpu.c ../bezier/*.c -o cpu_benchmark -lm -lpthread
+// Run: ./cpu_benchmark [-n count] [-c curves] [-k points] [-t patches] [-s seed]
+
+#include "../bezier/bezier.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <threads.h>
+
+struct options
+{
+	int count;
+	int curves;
+	int points;
+	int patches;
+	unsigned int seed;
+};
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+static float uniform(float low, float high)
+{
+	return low + (high - low) * (float)rand() / (float)RAND_MAX;
+}
+
+// Converts c0 + c1 t + c2 t^2 + c3 t^3 to Bernstein coefficients.
+static void power_to_bernstein(const double c[4], float a[4])
+{
+	a[0] = (float)c[0];
+	a[1] = (float)(c[0] + c[1] / 3.0);
+	a[2] = (float)(c[0] + 2.0 * c[1] / 3.0 + c[2] / 3.0);
+	a[3] = (float)(c[0] + c[1] + c[2] + c[3]);
+}
+
+// Coefficients in [-1,1], about half of which cross zero.
+static void random_cubics(int count, float* a)
+{
+	for (int i = 0; i < 4 * count; i++)
+		a[i] = uniform(-1.0f, 1.0f);
+}
+
+// ((t - r)^2 - e)(t - q) with a pair of roots (or none) within sqrt(|e|) of r and the third outside [0,1].
+static void near_tangent_cubics(int count, float* a)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const double r = uniform(0.1f, 0.9f);
+		const double e = (rand() % 2 ? 1 : -1) * pow(10.0, uniform(-8.0f, -3.0f));
+		const double q = uniform(1.5f, 3.0f);
+
+		// (t^2 - 2rt + r^2 - e)(t - q)
+		const double c[4] = {
+			-q * (r * r - e),
+			(r * r - e) + 2 * r * q,
+			-2 * r - q,
+			1,
+		};
+
+		power_to_bernstein(c, a + 4 * i);
+	}
+}
+
+static void roots(const struct options* options, const char* name, const float* a, enum bezier_solver solver, int* first)
+{
+	float* root = malloc(3 * options->count * sizeof(float));
+	int* root_count = malloc(options->count * sizeof(int));
+
+	int iterations = 0;
+	size_t total = 0;
+
+	const double start = now();
+
+	for (int i = 0; i < options->count; i++)
+	{
+		root_count[i] = bezier_cubic_roots(a + 4 * i, solver, root + total, &iterations);
+		total += root_count[i];
+	}
+
+	const double elapsed = now() - start;
+
+	// Residual relative to the coefficients (backward error) and the first order estimate |f/f'| of the distance to the true root.
+	double max_residual = 0;
+	double error = 0;
+	size_t offset = 0;
+
+	for (int i = 0; i < options->count; i++)
+	{
+		const float* c = a + 4 * i;
+		const double scale = fmax(fmax(fabs(c[0]), fabs(c[1])), fmax(fabs(c[2]), fabs(c[3])));
+
+		for (int j = 0; j < root_count[i]; j++, offset++)
+		{
+			const double t = root[offset];
+			const double s = 1 - t;
+
+			const double f = s * s * s * c[0] + 3 * s * s * t * c[1] + 3 * s * t * t * c[2] + t * t * t * c[3];
+			const double df = 3 * ((c[1] - c[0]) * s * s + 2 * (c[2] - c[1]) * s * t + (c[3] - c[2]) * t * t);
+
+			max_residual = fmax(max_residual, fabs(f) / scale);
+			error += df != 0 ? fabs(f / df) : 0;
+		}
+	}
+
+	printf("%s\n\t\t{\"benchmark\": \"roots\", \"curves\": \"%s\", \"solver\": \"%s\", \"count\": %d, \"roots\": %zu, "
+		"\"iterations_per_root\": %.2f, \"ns_per_root\": %.1f, \"ns_per_curve\": %.1f, "
+		"\"max_residual\": %.3g, \"mean_error_estimate\": %.3g}",
+		*first ? "" : ",",
+		name, solver == BEZIER_CLIPPING ? "clipping" : "bisection", options->count, total,
+		total ? (double)iterations / total : 0.0,
+		total ? 1e9 * elapsed / total : 0.0,
+		1e9 * elapsed / options->count,
+		max_residual, total ? error / total : 0.0);
+
+	*first = 0;
+
+	free(root_count);
+	free(root);
+}
+
+// Short random curves scattered over the unit square, as in a layout with many small strokes.
+static void random_curves(int count, float* curve)
+{
+	for (int i = 0; i < count; i++)
+	{
+		const float x = uniform(-1.0f, 1.0f);
+		const float y = uniform(-1.0f, 1.0f);
+
+		for (int j = 0; j < 4; j++)
+		{
+			curve[8 * i + 2 * j] = x + uniform(-0.05f, 0.05f);
+			curve[8 * i + 2 * j + 1] = y + uniform(-0.05f, 0.05f);
+		}
+	}
+}
+
+// Compares the sweep and prune broad phase against testing all pairs.
+static void curves(const struct options* options, int* first)
+{
+	const size_t count = options->curves;
+	const size_t capacity = 16 * count;
+
+	float* curve = malloc(8 * count * sizeof(float));
+	struct bezier_intersection* intersection = malloc(capacity * sizeof(struct bezier_intersection));
+
+	random_curves(options->curves, curve);
+
+	double start = now();
+	const size_t total = bezier_intersect_curves(count, curve, intersection, capacity);
+	const double sweep = now() - start;
+
+	size_t brute_total = 0;
+	start = now();
+
+	for (size_t i = 0; i < count; i++)
+		for (size_t j = i + 1; j < count; j++)
+		{
+			float s[9], t[9];
+			brute_total += bezier_curve_intersections(curve + 8 * i, curve + 8 * j, s, t);
+		}
+
+	const double brute = now() - start;
+
+	printf("%s\n\t\t{\"benchmark\": \"curves\", \"count\": %zu, \"intersections\": %zu, \"all_pairs_intersections\": %zu, "
+		"\"sweep_ms\": %.3f, \"all_pairs_ms\": %.3f, \"speedup\": %.1f}",
+		*first ? "" : ",",
+		count, total, brute_total, 1e3 * sweep, 1e3 * brute, brute / sweep);
+
+	*first = 0;
+
+	free(intersection);
+	free(curve);
+}
+
+// Arc length tables for the curves, as 'cubic curve' builds for its storage buffer.
+static void arc_length(const struct options* options, int* first)
+{
+	const size_t count = options->curves;
+
+	float* curve = malloc(8 * count * sizeof(float));
+	float* table = malloc(BEZIER_ARC_LENGTH_FLOATS * count * sizeof(float));
+
+	random_curves(options->curves, curve);
+
+	const double start = now();
+	bezier_arc_length_tables(BEZIER_PATCH_CUBIC_CURVE, count, curve, table);
+	const double elapsed = now() - start;
+
+	double length = 0;
+
+	for (size_t i = 0; i < count; i++)
+		length += table[BEZIER_ARC_LENGTH_FLOATS * i];
+
+	printf("%s\n\t\t{\"benchmark\": \"arc length\", \"count\": %zu, \"steps\": %d, \"mean_length\": %.4f, \"ms\": %.3f, \"curves_per_sec\": %.0f}",
+		*first ? "" : ",",
+		count, BEZIER_ARC_LENGTH_STEPS, length / count, 1e3 * elapsed, count / elapsed);
+
+	*first = 0;
+
+	free(table);
+	free(curve);
+}
+
+// Kinds of point and tangent specifications for bezier_conic_sections.
+enum conic_specification
+{
+	// P_1 inside the triangle of P_0, P_2 and where the tangents meet, so every one has an arc through the tangents' intersection.
+	CONIC_VALID,
+	// Parallel tangents with P_1 between them, half ellipses of weight 0.
+	CONIC_PARALLEL,
+	// Both tangents along the chord, every one written as the chord.
+	CONIC_DEGENERATE
+};
+
+static const char* conic_specification_name[] = { "valid", "parallel tangents", "degenerate" };
+
+// Conic sections from random point and tangent specifications, as 'conic section' loads them.
+static void conic_sections(const struct options* options, enum conic_specification kind, int* first)
+{
+	const size_t count = options->patches;
+
+	float* specification = malloc(10 * count * sizeof(float));
+	float* patch = malloc(9 * count * sizeof(float));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		float* c = specification + 10 * i;
+
+		// P_0 and P_2, then b as the tangents' intersection or their direction.
+		for (int k = 0; k < 2; k++)
+		{
+			c[4 * k] = uniform(-1, 1);
+			c[4 * k + 1] = uniform(-1, 1);
+		}
+
+		const float bx = uniform(-1, 1), by = uniform(-1, 1);
+
+		if (kind == CONIC_VALID)
+		{
+			// Barycentric coordinates of P_1, all at least 0.1.
+			const float a = uniform(0.1f, 0.8f), b = uniform(0.1f, 0.9f - a), e = 1.0f - a - b;
+
+			c[2] = a * c[0] + b * bx + e * c[4];
+			c[3] = a * c[1] + b * by + e * c[5];
+
+			// Tangent points part of the way to the intersection.
+			const float s = uniform(0.2f, 1.0f), t = uniform(0.2f, 1.0f);
+
+			c[6] = c[0] + s * (bx - c[0]);
+			c[7] = c[1] + s * (by - c[1]);
+			c[8] = c[4] + t * (bx - c[4]);
+			c[9] = c[5] + t * (by - c[5]);
+		}
+		else if (kind == CONIC_PARALLEL)
+		{
+			const float u = uniform(0.1f, 0.9f), v = uniform(0.1f, 1.0f);
+
+			c[2] = c[0] + u * (c[4] - c[0]) + v * bx;
+			c[3] = c[1] + u * (c[5] - c[1]) + v * by;
+
+			c[6] = c[0] + bx;
+			c[7] = c[1] + by;
+			c[8] = c[4] + bx;
+			c[9] = c[5] + by;
+		}
+		else
+		{
+			c[2] = bx;
+			c[3] = by;
+
+			c[6] = c[4];
+			c[7] = c[5];
+			c[8] = c[0];
+			c[9] = c[1];
+		}
+	}
+
+	const double start = now();
+	const size_t degenerate = bezier_conic_sections(count, specification, patch, NULL);
+	const double elapsed = now() - start;
+
+	printf("%s\n\t\t{\"benchmark\": \"conic sections\", \"specifications\": \"%s\", \"count\": %zu, \"degenerate\": %zu, \"ms\": %.3f, \"conics_per_sec\": %.0f}",
+		*first ? "" : ",",
+		conic_specification_name[kind], count, degenerate, 1e3 * elapsed, count / elapsed);
+
+	*first = 0;
+
+	free(patch);
+	free(specification);
+}
+
+// A frame of the solve stage benchmark, the curves' intersections with a line that moves each frame.
+struct solve_frame
+{
+	struct bezier_batch batch;
+	const float* curve;
+	float line[4];
+	float* root;
+	int* root_count;
+};
+
+static void solve_lines(struct bezier_batch* batch, size_t begin, size_t end)
+{
+	struct solve_frame* frame = batch->context;
+
+	bezier_intersect_lines(end - begin, frame->curve + 8 * begin, frame->line, 0, BEZIER_BISECTION, frame->root + 3 * begin, frame->root_count + begin);
+}
+
+static struct bezier_batch* move_line(struct solve_frame* frame, int f, int frames)
+{
+	const float y = -1.0f + 2.0f * f / frames;
+
+	frame->line[0] = -1.0f;
+	frame->line[1] = y;
+	frame->line[2] = 1.0f;
+	frame->line[3] = y + 0.1f;
+
+	return &frame->batch;
+}
+
+// Stands in for drawing a frame, evaluating every curve at 8 parameters and counting the roots solved for it.
+static size_t draw_frame(size_t count, const float* curve, const struct solve_frame* frame)
+{
+	static const float t[8] = { 0.0f, 1.0f / 7, 2.0f / 7, 3.0f / 7, 4.0f / 7, 5.0f / 7, 6.0f / 7, 1.0f };
+	float x[8], y[8];
+	size_t roots = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		bezier_cubic_curve(curve + 8 * i, 8, t, x, y);
+		roots += frame->root_count[i];
+	}
+
+	return roots + (x[0] > 2.0f);
+}
+
+// Solves the curves' intersections with a moving line each frame, first on the drawing thread before the draw
+// and then on a solve stage of 1 to 8 threads while the previous frame draws, timing frames and how long the drawing thread waits.
+static void solve_stage(const struct options* options, int* first)
+{
+	const size_t count = options->count;
+	const int frames = 20;
+
+	float* curve = malloc(8 * count * sizeof(float));
+	float* root = malloc(2 * 3 * count * sizeof(float));
+	int* root_count = malloc(2 * count * sizeof(int));
+
+	random_curves(options->count, curve);
+
+	struct solve_frame frame[2];
+
+	for (int i = 0; i < 2; i++)
+		frame[i] = (struct solve_frame){ .batch = { .function = solve_lines, .count = count, .grain = 256, .context = &frame[i] },
+			.curve = curve, .root = root + 3 * count * i, .root_count = root_count + count * i };
+
+	for (int threads = 0; threads <= 8; threads = threads ? 2 * threads : 1)
+	{
+		struct bezier_stage* stage = threads ? bezier_stage_create(threads, 2) : NULL;
+
+		if (threads && !stage)
+		{
+			fprintf(stderr, "Unable to start a solve stage of %d threads\n", threads);
+			break;
+		}
+
+		size_t roots = 0;
+		double waited = 0;
+		const double start = now();
+
+		if (stage)
+			bezier_stage_submit(stage, move_line(&frame[0], 0, frames));
+
+		for (int f = 0; f < frames; f++)
+		{
+			// Frame f + 1 is solved while frame f draws.
+			if (stage)
+			{
+				const double wait = now();
+
+				while (!bezier_stage_take(stage))
+					thrd_yield();
+
+				waited += now() - wait;
+
+				if (f + 1 < frames)
+					bezier_stage_submit(stage, move_line(&frame[(f + 1) % 2], f + 1, frames));
+			}
+			else
+				solve_lines(move_line(&frame[f % 2], f, frames), 0, count);
+
+			roots += draw_frame(count, curve, &frame[f % 2]);
+		}
+
+		const double elapsed = now() - start;
+
+		printf("%s\n\t\t{\"benchmark\": \"solve stage\", \"count\": %zu, \"threads\": %d, \"mode\": \"%s\", \"roots_per_frame\": %.1f, "
+			"\"frame_ms\": %.3f, \"wait_ms\": %.3f}",
+			*first ? "" : ",",
+			count, threads ? threads : 1, stage ? "overlapped" : "serial", (double)roots / frames, 1e3 * elapsed / frames, 1e3 * waited / frames);
+
+		*first = 0;
+
+		bezier_stage_destroy(stage);
+	}
+
+	free(root_count);
+	free(root);
+	free(curve);
+}
+
+// Linear scan with the same semantics as bezier_picker_nearest.
+static long scan_nearest(size_t count, const float* point, float x, float y, float radius)
+{
+	long nearest = -1;
+	float best = radius * radius;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		const float dx = point[2 * i] - x;
+		const float dy = point[2 * i + 1] - y;
+		const float distance = dx * dx + dy * dy;
+
+		if (distance <= best)
+		{
+			best = distance;
+			nearest = (long)i;
+		}
+	}
+
+	return nearest;
+}
+
+// Picking among control points scattered over a 640 pixel square screen with a 3 pixel radius, as the demonstrations do,
+// against scanning every point. Half the points are moved between the queries to exercise the incremental updates.
+static void picking(const struct options* options, int* first)
+{
+	const size_t count = options->points;
+	const int queries = 10000;
+	const float low[2] = { 0, 0 }, high[2] = { 640, 640 };
+
+	float* point = malloc(2 * count * sizeof(float));
+	size_t* selection = malloc(count * sizeof(size_t));
+	float* query = malloc(4 * queries * sizeof(float));
+
+	for (size_t i = 0; i < 2 * count; i++)
+		point[i] = uniform(0.0f, 640.0f);
+
+	// Query near existing points so most queries hit, and boxes 32 pixels wide.
+	for (int i = 0; i < queries; i++)
+	{
+		const size_t j = rand() % count;
+
+		query[4 * i] = point[2 * j] + uniform(-2.0f, 2.0f);
+		query[4 * i + 1] = point[2 * j + 1] + uniform(-2.0f, 2.0f);
+		query[4 * i + 2] = uniform(0.0f, 608.0f);
+		query[4 * i + 3] = uniform(0.0f, 608.0f);
+	}
+
+	struct bezier_picker picker;
+
+	double start = now();
+	const int failed = bezier_picker_init(&picker, count, point, low, high, 8.0f);
+	const double build = now() - start;
+
+	if (failed)
+	{
+		fprintf(stderr, "Unable to allocate the picker\n");
+		free(query);
+		free(selection);
+		free(point);
+		return;
+	}
+
+	start = now();
+
+	for (size_t i = 0; i < count; i += 2)
+	{
+		point[2 * i] = uniform(0.0f, 640.0f);
+		point[2 * i + 1] = uniform(0.0f, 640.0f);
+		bezier_picker_move(&picker, i, point[2 * i], point[2 * i + 1]);
+	}
+
+	const double move = now() - start;
+
+	long hits = 0, checksum = 0;
+	start = now();
+
+	for (int i = 0; i < queries; i++)
+	{
+		const long nearest = bezier_picker_nearest(&picker, query[4 * i], query[4 * i + 1], 3.0f);
+
+		hits += nearest >= 0;
+		checksum += nearest;
+	}
+
+	const double nearest = now() - start;
+
+	long scan_checksum = 0;
+	start = now();
+
+	for (int i = 0; i < queries; i++)
+		scan_checksum += scan_nearest(count, point, query[4 * i], query[4 * i + 1], 3.0f);
+
+	const double scan = now() - start;
+
+	size_t selected = 0, scan_selected = 0;
+	start = now();
+
+	for (int i = 0; i < queries; i++)
+		selected += bezier_picker_box(&picker, query + 4 * i + 2, (float[2]) { query[4 * i + 2] + 32, query[4 * i + 3] + 32 }, selection, count);
+
+	const double box = now() - start;
+
+	start = now();
+
+	for (int i = 0; i < queries; i++)
+		for (size_t j = 0; j < count; j++)
+			scan_selected += point[2 * j] >= query[4 * i + 2] && point[2 * j] <= query[4 * i + 2] + 32
+				&& point[2 * j + 1] >= query[4 * i + 3] && point[2 * j + 1] <= query[4 * i + 3] + 32;
+
+	const double box_scan = now() - start;
+
+	printf("%s\n\t\t{\"benchmark\": \"picking\", \"points\": %zu, \"queries\": %d, \"hits\": %ld, \"matches_scan\": %s, "
+		"\"build_ms\": %.3f, \"ns_per_move\": %.1f, \"ns_per_nearest\": %.1f, \"ns_per_nearest_scan\": %.1f, "
+		"\"ns_per_box\": %.1f, \"ns_per_box_scan\": %.1f}",
+		*first ? "" : ",",
+		count, queries, hits, checksum == scan_checksum && selected == scan_selected ? "true" : "false",
+		1e3 * build, 1e9 * move / ((count + 1) / 2), 1e9 * nearest / queries, 1e9 * scan / queries,
+		1e9 * box / queries, 1e9 * box_scan / queries);
+
+	*first = 0;
+
+	bezier_picker_free(&picker);
+	free(query);
+	free(selection);
+	free(point);
+}
+
+// Closest point by evaluating the patch at a dense grid of parameters, the reference for bezier_hit_test.
+static double sampled_distance(enum bezier_patch type, const float* p, float x, float y)
+{
+	const int samples = type == BEZIER_PATCH_BICUBIC_RECTANGLE ? 400 : 20000;
+	float u[400], v[400], px[400], py[400];
+	double best = INFINITY;
+
+	for (int i = 0; i < samples; i += 400)
+	{
+		for (int j = 0; j < 400; j++)
+		{
+			u[j] = type == BEZIER_PATCH_BICUBIC_RECTANGLE ? (float)i / (samples - 1) : (float)(i + j) / (samples - 1);
+			v[j] = (float)j / 399;
+		}
+
+		if (type == BEZIER_PATCH_CUBIC_CURVE)
+			bezier_cubic_curve(p, 400, u, px, py);
+		else if (type == BEZIER_PATCH_RATIONAL_QUADRATIC)
+			bezier_rational_quadratic(p, 400, u, px, py);
+		else if (type == BEZIER_PATCH_RATIONAL_CUBIC_CURVE)
+			bezier_rational_cubic_curve(p, 400, u, px, py);
+
+		if (type != BEZIER_PATCH_BICUBIC_RECTANGLE)
+			for (int j = 0; j < 400; j++)
+				best = fmin(best, hypot(px[j] - x, py[j] - y));
+	}
+
+	// Surfaces are sampled on a 400 by 400 grid, a row of u at a time.
+	for (int i = 0; type == BEZIER_PATCH_BICUBIC_RECTANGLE && i < 400; i++)
+	{
+		for (int j = 0; j < 400; j++)
+		{
+			u[j] = (float)i / 399;
+			v[j] = (float)j / 399;
+		}
+
+		bezier_bicubic_rectangle(p, 400, u, v, px, py);
+
+		for (int j = 0; j < 400; j++)
+			best = fmin(best, hypot(px[j] - x, py[j] - y));
+	}
+
+	return best;
+}
+
+// Box of the points at samples uniform parameters of a curve, grown by margin.
+static void sampled_box(enum bezier_patch type, const float* p, int samples, float margin, float box[4])
+{
+	float u[256], px[256], py[256];
+
+	box[0] = box[1] = INFINITY;
+	box[2] = box[3] = -INFINITY;
+
+	for (int i = 0; i < samples; i += 256)
+	{
+		for (int j = 0; j < 256; j++)
+			u[j] = (float)(i + j) / (samples - 1);
+
+		if (type == BEZIER_PATCH_CUBIC_CURVE)
+			bezier_cubic_curve(p, 256, u, px, py);
+		else if (type == BEZIER_PATCH_RATIONAL_QUADRATIC)
+			bezier_rational_quadratic(p, 256, u, px, py);
+		else
+			bezier_rational_cubic_curve(p, 256, u, px, py);
+
+		for (int j = 0; j < 256 && i + j < samples; j++)
+		{
+			box[0] = fminf(box[0], px[j] - margin);
+			box[1] = fminf(box[1], py[j] - margin);
+			box[2] = fmaxf(box[2], px[j] + margin);
+			box[3] = fmaxf(box[3], py[j] + margin);
+		}
+	}
+}
+
+// Hit tests against patches scattered over a 640 pixel square screen with a 3 pixel radius, as for hovering.
+// A sample of the hits is checked against sampling the patches densely, the error is how much further the hit is than the sampled point.
+// Conics can instead have the middle weights bezier_conic_sections gives arcs past parallel tangents: 0 for a quarter, the rest in (-3/4,0).
+// The check then only samples curves near the query by their sampled boxes rather than the tester's, which split such conics.
+static void hit_testing(const struct options* options, const char* name, enum bezier_patch type, int nonpositive, int* first)
+{
+	const int floats = bezier_patch_floats(type);
+	const size_t count = options->patches;
+	const int queries = 10000;
+	const int checked = 100;
+	const float radius = 3.0f;
+
+	float* patch = malloc(floats * count * sizeof(float));
+	float* query = malloc(2 * queries * sizeof(float));
+
+	// Patches around 30 pixels across, surfaces are perturbed grids so they don't fold over.
+	for (size_t i = 0; i < count; i++)
+	{
+		const float x = uniform(0.0f, 640.0f);
+		const float y = uniform(0.0f, 640.0f);
+		float* p = patch + floats * i;
+
+		if (type == BEZIER_PATCH_BICUBIC_RECTANGLE)
+			for (int k = 0; k < 16; k++)
+			{
+				p[2 * k] = x + 10.0f * (k % 4) + uniform(-3.0f, 3.0f);
+				p[2 * k + 1] = y + 10.0f * (k / 4) + uniform(-3.0f, 3.0f);
+			}
+		else if (type == BEZIER_PATCH_RATIONAL_QUADRATIC || type == BEZIER_PATCH_RATIONAL_CUBIC_CURVE)
+			for (int k = 0; k < floats / 3; k++)
+			{
+				const float w = type == BEZIER_PATCH_RATIONAL_CUBIC_CURVE || k == 1 ? uniform(0.25f, 4.0f) : 1.0f;
+
+				p[3 * k] = w * (x + uniform(-15.0f, 15.0f));
+				p[3 * k + 1] = w * (y + uniform(-15.0f, 15.0f));
+				p[3 * k + 2] = w;
+
+				// A zero weight's point is the half ellipse's direction from the chord.
+				if (nonpositive && k == 1)
+				{
+					p[5] = i % 4 ? uniform(-0.75f, 0.0f) : 0.0f;
+					p[3] = p[5] ? p[5] * (x + uniform(-15.0f, 15.0f)) : uniform(-15.0f, 15.0f);
+					p[4] = p[5] ? p[5] * (y + uniform(-15.0f, 15.0f)) : uniform(-15.0f, 15.0f);
+				}
+			}
+		else
+			for (int k = 0; k < 8; k++)
+				p[k] = (k % 2 ? y : x) + uniform(-15.0f, 15.0f);
+	}
+
+	for (int i = 0; i < 2 * queries; i++)
+		query[i] = uniform(0.0f, 640.0f);
+
+	float* reference_box = NULL;
+
+	if (nonpositive)
+	{
+		reference_box = malloc(4 * count * sizeof(float));
+
+		for (size_t i = 0; reference_box && i < count; i++)
+			sampled_box(type, patch + floats * i, 1024, 1.0f, reference_box + 4 * i);
+	}
+
+	struct bezier_hit_tester tester;
+
+	if (bezier_hit_init(&tester, type, count, patch))
+	{
+		fprintf(stderr, "Unable to allocate the hit tester\n");
+		free(query);
+		free(patch);
+		return;
+	}
+
+	int hits = 0;
+	struct bezier_hit hit;
+
+	const double start = now();
+
+	for (int i = 0; i < queries; i++)
+		hits += bezier_hit_test(&tester, query[2 * i], query[2 * i + 1], radius, &hit);
+
+	const double elapsed = now() - start;
+
+	double max_error = 0;
+
+	for (int i = 0; i < checked; i++)
+	{
+		const float x = query[2 * i], y = query[2 * i + 1];
+
+		double reference = radius;
+
+		for (size_t j = 0; j < count; j++)
+		{
+			const float* box = (reference_box ? reference_box : tester.box) + 4 * j;
+
+			if (x > box[0] - radius && x < box[2] + radius && y > box[1] - radius && y < box[3] + radius)
+				reference = fmin(reference, sampled_distance(type, patch + floats * j, x, y));
+		}
+
+		const double found = bezier_hit_test(&tester, x, y, radius, &hit) ? hit.distance : radius;
+
+		max_error = fmax(max_error, found - reference);
+	}
+
+	printf("%s\n\t\t{\"benchmark\": \"hit testing\", \"patches\": \"%s\", \"count\": %zu, \"queries\": %d, \"hits\": %d, "
+		"\"us_per_query\": %.3f, \"max_error\": %.3g}",
+		*first ? "" : ",",
+		name, count, queries, hits, 1e6 * elapsed / queries, max_error);
+
+	*first = 0;
+
+	bezier_hit_free(&tester);
+	free(reference_box);
+	free(query);
+	free(patch);
+}
+
+// Tessellates patches scattered as for hit testing at a fixed level on 1 to 8 threads, allocating from one arena that is reset between runs.
+static void tessellation(const struct options* options, const char* name, enum bezier_patch type, int* first)
+{
+	const int floats = bezier_patch_floats(type);
+	const size_t count = options->patches;
+	const float level = 8.0f;
+
+	float* patch = malloc(floats * count * sizeof(float));
+	struct bezier_levels* levels = malloc(count * sizeof(struct bezier_levels));
+
+	for (size_t i = 0; i < count; i++)
+	{
+		for (int k = 0; k < floats; k++)
+			patch[floats * i + k] = uniform(-1.0f, 1.0f);
+
+		// Positive weights for the rational patches.
+		if (type == BEZIER_PATCH_RATIONAL_QUADRATIC || type == BEZIER_PATCH_RATIONAL_CUBIC_CURVE || type == BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE || type == BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE)
+			for (int k = 2; k < floats; k += 3)
+				patch[floats * i + k] = uniform(0.25f, 4.0f);
+
+		levels[i] = (struct bezier_levels){ .outer = { level, level, level, level }, .inner = { level, level } };
+
+		if (type == BEZIER_PATCH_CUBIC_CURVE || type == BEZIER_PATCH_RATIONAL_QUADRATIC || type == BEZIER_PATCH_RATIONAL_CUBIC_CURVE)
+			levels[i].outer[0] = 1.0f;
+	}
+
+	struct bezier_arena arena;
+
+	if (bezier_arena_init(&arena, count * 4096 + (1 << 20)))
+	{
+		fprintf(stderr, "Unable to allocate the arena\n");
+		free(levels);
+		free(patch);
+		return;
+	}
+
+	for (int threads = 1; threads <= 8; threads *= 2)
+	{
+		struct bezier_mesh mesh;
+
+		bezier_arena_reset(&arena);
+
+		const double start = now();
+		const int failed = bezier_tessellate(type, count, patch, levels, threads, &arena, &mesh);
+		const double elapsed = now() - start;
+
+		if (failed)
+		{
+			fprintf(stderr, "The arena is too small to tessellate %s\n", name);
+			break;
+		}
+
+		printf("%s\n\t\t{\"benchmark\": \"tessellation\", \"patches\": \"%s\", \"count\": %zu, \"level\": %g, \"threads\": %d, "
+			"\"vertices\": %zu, \"primitives\": %zu, \"ms\": %.3f, \"vertices_per_sec\": %.0f}",
+			*first ? "" : ",",
+			name, count, level, threads, mesh.vertex_count, mesh.index_count / mesh.primitive_vertices, 1e3 * elapsed, mesh.vertex_count / elapsed);
+
+		*first = 0;
+	}
+
+	bezier_arena_free(&arena);
+	free(levels);
+	free(patch);
+}
+
+int parse_options(int argc, char* args[], struct options* options)
+{
+	*options = (struct options){
+		.count = 100000,
+		.curves = 5000,
+		.points = 100000,
+		.patches = 20000,
+		.seed = 1,
+	};
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (i + 1 == argc)
+			return 1;
+
+		const char* value = args[++i];
+
+		if (!strcmp(args[i - 1], "-n"))
+			options->count = atoi(value);
+		else if (!strcmp(args[i - 1], "-c"))
+			options->curves = atoi(value);
+		else if (!strcmp(args[i - 1], "-k"))
+			options->points = atoi(value);
+		else if (!strcmp(args[i - 1], "-t"))
+			options->patches = atoi(value);
+		else if (!strcmp(args[i - 1], "-s"))
+			options->seed = (unsigned int)atoi(value);
+		else
+			return 1;
+	}
+
+	return options->count < 1 || options->curves < 1 || options->points < 1 || options->patches < 1;
+}
+
+int main(int argc, char* args[])
+{
+	struct options options;
+
+	if (parse_options(argc, args, &options))
+	{
+		fprintf(stderr, "usage: %s [-n count] [-c curves] [-k points] [-t patches] [-s seed]\n", args[0]);
+		return 1;
+	}
+
+	srand(options.seed);
+
+	printf("{\n\t\"simd\": \"%s\",\n\t\"lanes\": %d,\n\t\"results\": [", bezier_simd_name(), bezier_simd_width());
+
+	int first = 1;
+	float* a = malloc(4 * options.count * sizeof(float));
+
+	random_cubics(options.count, a);
+	roots(&options, "random", a, BEZIER_BISECTION, &first);
+	roots(&options, "random", a, BEZIER_CLIPPING, &first);
+
+	near_tangent_cubics(options.count, a);
+	roots(&options, "near tangent", a, BEZIER_BISECTION, &first);
+	roots(&options, "near tangent", a, BEZIER_CLIPPING, &first);
+
+	free(a);
+
+	curves(&options, &first);
+	arc_length(&options, &first);
+	conic_sections(&options, CONIC_VALID, &first);
+	conic_sections(&options, CONIC_PARALLEL, &first);
+	conic_sections(&options, CONIC_DEGENERATE, &first);
+	solve_stage(&options, &first);
+	picking(&options, &first);
+
+	hit_testing(&options, "cubic curve", BEZIER_PATCH_CUBIC_CURVE, 0, &first);
+	hit_testing(&options, "conic section", BEZIER_PATCH_RATIONAL_QUADRATIC, 0, &first);
+	hit_testing(&options, "conic section, w <= 0", BEZIER_PATCH_RATIONAL_QUADRATIC, 1, &first);
+	hit_testing(&options, "bicubic rectangle", BEZIER_PATCH_BICUBIC_RECTANGLE, 0, &first);
+	hit_testing(&options, "rational cubic curve", BEZIER_PATCH_RATIONAL_CUBIC_CURVE, 0, &first);
+
+	tessellation(&options, "cubic curve", BEZIER_PATCH_CUBIC_CURVE, &first);
+	tessellation(&options, "conic section", BEZIER_PATCH_RATIONAL_QUADRATIC, &first);
+	tessellation(&options, "bicubic rectangle", BEZIER_PATCH_BICUBIC_RECTANGLE, &first);
+	tessellation(&options, "cubic triangle", BEZIER_PATCH_CUBIC_TRIANGLE, &first);
+	tessellation(&options, "rational cubic curve", BEZIER_PATCH_RATIONAL_CUBIC_CURVE, &first);
+	tessellation(&options, "rational bicubic rectangle", BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE, &first);
+	tessellation(&options, "rational cubic triangle", BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE, &first);
+
+	printf("\n\t]\n}\n");
+
+	return 0;
+}
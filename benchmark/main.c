@@ -0,0 +1,1945 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// Headless benchmark of the demonstrations' shader pipelines.
+// Each demonstration's shaders are loaded from its directory, a grid of copies of its patch is drawn into an offscreen framebuffer,
+// and the results are written to stdout as JSON.
+// Every patch is drawn at each fixed level (the control shaders' 'level' uniform) and then adaptively at each pixel error target,
+// once for each way of submitting the copies (see enum submission) and of evaluating them (see enum evaluation).
+// The cubic patches are also drawn in rational form ('rational cubic curve' etc.), with a weight per control point, to compare against the polynomial ones.
+// The 'feedback' submission captures the tessellated vertices with transform feedback and redraws them, re-tessellating only the patches edited each frame (-u).
+// The 'compute' submission replaces the tessellation shaders with the directory's compute.glsl (the curves have one), whose levels aren't capped by GL_MAX_TESS_GEN_LEVEL.
+// With -v the results instead check the CPU tessellator (bezier_tessellate, run on the given number of threads) against transform feedback captures
+// of the demonstrations it reproduces at each fixed level, and the exit status is non-zero if any differ.
+// With -c programs are cached as binaries in the given (existing) directory, the 'programs' section reports whether each was a hit and the time to build it.
+// No window is created: the context comes from EGL's surfaceless platform so this runs on machines without a GPU (e.g. Mesa's llvmpipe).
+//
+// Build (Linux): cc -O2 -mavx2 -mfma main.c ../bezier/*.c -o benchmark -lEGL -lOpenGL -lm
+// Run from this directory: ./benchmark [-p patches] [-f frames] [-l level,level,...] [-e pixel_error,pixel_error,...] [-s submission,...] [-m evaluation,...] [-u edited] [-v threads] [-d demonstration] [-r root] [-c cache]
+
+#define GL_GLEXT_PROTOTYPES
+#include "../bezier/bezier.h"
+
+#include <EGL/egl.h>
+#include <EGL/eglext.h>
+#include <GL/glcorearb.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+
+#define SCREEN_WIDTH 640
+#define SCREEN_HEIGHT SCREEN_WIDTH
+
+#define MAX_LEVELS 32
+#define MAX_PIXEL_ERRORS 32
+#define WARMUP_FRAMES 5
+
+// How the copies are submitted: a single draw call for the whole buffer, a call per copy as the demonstrations draw their patch,
+// one glMultiDraw*Indirect call with a command per copy so each copy can live anywhere in the buffer,
+// or one glMultiDrawArrays call of the vertices the copies were tessellated into by earlier frames, see struct feedback,
+// or a compute shader evaluating every copy each frame followed by one indexed draw of its lines, see struct compute.
+enum submission
+{
+	SUBMIT_SINGLE,
+	SUBMIT_PER_PATCH,
+	SUBMIT_INDIRECT,
+	SUBMIT_FEEDBACK,
+	SUBMIT_COMPUTE,
+	SUBMISSIONS
+};
+
+static const char* submission_name[SUBMISSIONS] = { "single", "per_patch", "indirect", "feedback", "compute" };
+
+// How the evaluation shaders evaluate the patches: de Casteljau's algorithm, or Horner's rule on power basis coefficients
+// the control shaders compute once per patch (their 'power_basis' uniform, which only the cubic patches have),
+// or de Casteljau's at equal steps of arc length looked up in a table per patch ('arc_length', which only the cubic curves have).
+// The power basis rows report how far their vertices are from de Casteljau's, the arc length rows how far their lines stray from the curve.
+enum evaluation
+{
+	EVALUATE_CASTELJAU,
+	EVALUATE_POWER,
+	EVALUATE_ARC_LENGTH,
+	EVALUATIONS
+};
+
+static const char* evaluation_name[EVALUATIONS] = { "casteljau", "power", "arc_length" };
+
+// The uniform selecting each evaluation, demonstrations without it are only drawn with de Casteljau's.
+static const char* evaluation_uniform[EVALUATIONS] = { NULL, "power_basis", "arc_length" };
+
+// Layouts of the commands read by glMultiDrawArraysIndirect and glMultiDrawElementsIndirect.
+struct draw_arrays_command
+{
+	GLuint count;
+	GLuint instance_count;
+	GLuint first;
+	GLuint base_instance;
+};
+
+struct draw_elements_command
+{
+	GLuint count;
+	GLuint instance_count;
+	GLuint first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+};
+
+struct attribute
+{
+	GLuint location;
+	GLint size;
+	GLsizei offset;
+};
+
+struct demo
+{
+	const char* directory;
+	// Shown in the results and matched by -d, the directory if NULL.
+	const char* name;
+
+	GLint patch_vertices;
+	GLsizei stride;
+	struct attribute attribute[4];
+
+	GLsizei vertex_count;
+	const GLfloat* vertex;
+
+	GLsizei index_count;
+	const GLuint* index;
+
+	GLenum primitive;
+
+	// The evaluation shader's output besides gl_Position (at location 0, as the fragment shader reads it), captured by transform feedback.
+	const char* varying;
+	GLint varying_size;
+
+	// Every vertex is homogeneous (w*x, w*y, w) with w at location 1, see the cubic patches' and the conic's vertex shaders.
+	int rational;
+
+	// The directory has a compute.glsl for the 'compute' submission.
+	int compute;
+};
+
+static const char* demo_name(const struct demo* demo)
+{
+	return demo->name ? demo->name : demo->directory;
+}
+
+static const GLfloat cubic_curve[] = {
+	-0.5, 0.0,
+	-0.2, 0.4,
+	 0.2,-0.4,
+	 0.5, 0.0,
+};
+
+static const GLfloat bicubic_rectangle[] = {
+	-0.5,-0.5,  -0.5+1.0/3.0,-0.5,  -0.5+2.0/3.0,-0.5,  0.5,-0.5,
+	-0.5,-0.5+1.0/3.0,  -0.5+1.0/3.0,-0.5+1.0/3.0,  -0.5+2.0/3.0,-0.5+1.0/3.0,  0.5,-0.5+1.0/3.0,
+	-0.5,-0.5+2.0/3.0,  -0.5+1.0/3.0,-0.5+2.0/3.0,  -0.5+2.0/3.0,-0.5+2.0/3.0,  0.5,-0.5+2.0/3.0,
+	-0.5, 0.5,  -0.5+1.0/3.0, 0.5,  -0.5+2.0/3.0, 0.5,  0.5, 0.5,
+};
+
+static const GLfloat cubic_triangle[] = {
+	 0.000000f, 0.500000f,
+	-0.306250f, 0.275000f,
+	-0.350000f,-0.250000f,
+	-0.487500f,-0.083333f,
+	-0.400000f,-0.400000f,
+	-0.234375f,-0.429167f,
+	-0.500000f,-0.500000f,
+	-0.200000f,-0.600000f,
+	 0.200000f,-0.600000f,
+	 0.500000f,-0.500000f,
+};
+
+// Rational forms of the patches above as homogeneous (w*x, w*y, w) points.
+// A quarter circle raised to a cubic has inner weights (1 + sqrt 2) / 3, the curve is an exact arc of radius 0.8 about (-0.4,-0.4),
+// the rectangle and triangle use the same weights along their edges and products of them inside.
+#define ARC_WEIGHT 0.80473785f
+#define HOMOGENEOUS(x, y, w) (x) * (w), (y) * (w), (w)
+
+static const GLfloat rational_cubic_curve[] = {
+	HOMOGENEOUS( 0.4f,-0.4f, 1.0f),
+	(0.4f + 1.41421356f * 0.4f) / 3.0f, (-0.4f + 1.41421356f * 0.4f) / 3.0f, ARC_WEIGHT,
+	(-0.4f + 1.41421356f * 0.4f) / 3.0f, (0.4f + 1.41421356f * 0.4f) / 3.0f, ARC_WEIGHT,
+	HOMOGENEOUS(-0.4f, 0.4f, 1.0f),
+};
+
+static const GLfloat rational_bicubic_rectangle[] = {
+	HOMOGENEOUS(-0.5f,-0.5f, 1.0f),  HOMOGENEOUS(-0.5f+1.0f/3.0f,-0.5f, ARC_WEIGHT),  HOMOGENEOUS(-0.5f+2.0f/3.0f,-0.5f, ARC_WEIGHT),  HOMOGENEOUS(0.5f,-0.5f, 1.0f),
+	HOMOGENEOUS(-0.5f,-0.5f+1.0f/3.0f, ARC_WEIGHT),  HOMOGENEOUS(-0.5f+1.0f/3.0f,-0.5f+1.0f/3.0f, ARC_WEIGHT * ARC_WEIGHT),  HOMOGENEOUS(-0.5f+2.0f/3.0f,-0.5f+1.0f/3.0f, ARC_WEIGHT * ARC_WEIGHT),  HOMOGENEOUS(0.5f,-0.5f+1.0f/3.0f, ARC_WEIGHT),
+	HOMOGENEOUS(-0.5f,-0.5f+2.0f/3.0f, ARC_WEIGHT),  HOMOGENEOUS(-0.5f+1.0f/3.0f,-0.5f+2.0f/3.0f, ARC_WEIGHT * ARC_WEIGHT),  HOMOGENEOUS(-0.5f+2.0f/3.0f,-0.5f+2.0f/3.0f, ARC_WEIGHT * ARC_WEIGHT),  HOMOGENEOUS(0.5f,-0.5f+2.0f/3.0f, ARC_WEIGHT),
+	HOMOGENEOUS(-0.5f, 0.5f, 1.0f),  HOMOGENEOUS(-0.5f+1.0f/3.0f, 0.5f, ARC_WEIGHT),  HOMOGENEOUS(-0.5f+2.0f/3.0f, 0.5f, ARC_WEIGHT),  HOMOGENEOUS(0.5f, 0.5f, 1.0f),
+};
+
+static const GLfloat rational_cubic_triangle[] = {
+	HOMOGENEOUS( 0.000000f, 0.500000f, 1.0f),
+	HOMOGENEOUS(-0.306250f, 0.275000f, ARC_WEIGHT),
+	HOMOGENEOUS(-0.350000f,-0.250000f, ARC_WEIGHT),
+	HOMOGENEOUS(-0.487500f,-0.083333f, ARC_WEIGHT),
+	HOMOGENEOUS(-0.400000f,-0.400000f, ARC_WEIGHT * ARC_WEIGHT),
+	HOMOGENEOUS(-0.234375f,-0.429167f, ARC_WEIGHT),
+	HOMOGENEOUS(-0.500000f,-0.500000f, 1.0f),
+	HOMOGENEOUS(-0.200000f,-0.600000f, ARC_WEIGHT),
+	HOMOGENEOUS( 0.200000f,-0.600000f, ARC_WEIGHT),
+	HOMOGENEOUS( 0.500000f,-0.500000f, 1.0f),
+};
+
+// P_0, B, P_2 of the initial conic section.
+// Homogeneous (w*x, w*y, w), the middle weight 0.75.
+static const GLfloat conic_section[] = {
+	-0.3, 0.0,   1.0,
+	 0.0, 0.375, 0.75,
+	 0.3, 0.0,   1.0,
+};
+
+// x,y,width,r,g,b,distance of the stroked path, its segments' patches are the cubic and the next segment's other three points.
+// As the demonstration's, the middle segment's P_2 is retracted onto its P_3.
+static const GLfloat width_and_color[] = {
+	-0.8,-0.2, 0.030, 1.0, 0.0, 0.0, 0.0,
+	-0.7, 0.4, 0.060, 0.8, 0.0, 0.2, 0.0,
+	-0.4, 0.4, 0.040, 0.7, 0.0, 0.3, 0.0,
+	-0.3, 0.0, 0.050, 0.6, 0.0, 0.4, 0.0,
+	 0.0, 0.2, 0.030, 0.5, 0.0, 0.5, 0.0,
+	 0.3,-0.3, 0.040, 0.4, 0.0, 0.6, 0.0,
+	 0.3,-0.3, 0.060, 0.3, 0.0, 0.7, 0.0,
+	 0.4, 0.1, 0.040, 0.2, 0.0, 0.8, 0.0,
+	 0.7, 0.3, 0.050, 0.1, 0.0, 0.9, 0.0,
+	 0.8,-0.2, 0.030, 0.0, 0.0, 1.0, 0.0,
+};
+
+static const GLuint width_and_color_index[] = {
+	0,1,2,3,4,5,6,
+	3,4,5,6,7,8,9,
+	6,7,8,9,9,9,9,
+};
+
+static const GLfloat composite_curve[] = {
+	-0.5, -0.5,
+	-0.5, -0.9,
+	 0.0,  0.5,
+	-0.5,  0.5,
+	 0.5, -0.5,
+	 0.5, -0.9,
+};
+
+static const GLuint composite_index[] = {
+	0,1,
+	1,2,
+	2,0
+};
+
+static const struct demo demos[] = {
+	{
+		.directory = "cubic curve",
+		.patch_vertices = 4, .stride = 2, .attribute = { { 0, 2, 0 } },
+		.vertex_count = 4, .vertex = cubic_curve,
+		.primitive = GL_LINES,
+		.varying = "tessCoord", .varying_size = 2,
+		.compute = 1,
+	},
+	{
+		.directory = "bicubic rectangle",
+		.patch_vertices = 16, .stride = 2, .attribute = { { 0, 2, 0 } },
+		.vertex_count = 16, .vertex = bicubic_rectangle,
+		.primitive = GL_TRIANGLES,
+		.varying = "tessCoord", .varying_size = 2,
+	},
+	{
+		.directory = "cubic triangle",
+		.patch_vertices = 10, .stride = 2, .attribute = { { 0, 2, 0 } },
+		.vertex_count = 10, .vertex = cubic_triangle,
+		.primitive = GL_TRIANGLES,
+		.varying = "barycoordinates", .varying_size = 3,
+	},
+	{
+		.directory = "conic section",
+		.patch_vertices = 3, .stride = 3, .attribute = { { 0, 2, 0 }, { 1, 1, 2 } },
+		.vertex_count = 3, .vertex = conic_section,
+		.primitive = GL_LINES,
+		.varying = "tessCoord", .varying_size = 2,
+		.rational = 1, .compute = 1,
+	},
+	{
+		.directory = "width and color",
+		.patch_vertices = 7, .stride = 7, .attribute = { { 0, 2, 0 }, { 1, 1, 2 }, { 2, 3, 3 }, { 3, 1, 6 } },
+		.vertex_count = 10, .vertex = width_and_color,
+		.index_count = 21, .index = width_and_color_index,
+		.primitive = GL_TRIANGLES,
+		.varying = "stroke", .varying_size = 4,
+	},
+	{
+		.directory = "composite curve",
+		.patch_vertices = 2, .stride = 4, .attribute = { { 0, 2, 0 }, { 1, 2, 2 } },
+		.vertex_count = 3, .vertex = composite_curve,
+		.index_count = 6, .index = composite_index,
+		.primitive = GL_LINES,
+		.varying = "tessCoord", .varying_size = 2,
+	},
+	{
+		.directory = "intersections",
+		.patch_vertices = 4, .stride = 2, .attribute = { { 0, 2, 0 } },
+		.vertex_count = 4, .vertex = cubic_curve,
+		.primitive = GL_LINES,
+		.varying = "tessCoord", .varying_size = 2,
+	},
+	{
+		.directory = "cubic curve", .name = "rational cubic curve",
+		.patch_vertices = 4, .stride = 3, .attribute = { { 0, 2, 0 }, { 1, 1, 2 } },
+		.vertex_count = 4, .vertex = rational_cubic_curve,
+		.primitive = GL_LINES,
+		.varying = "tessCoord", .varying_size = 2,
+		.rational = 1, .compute = 1,
+	},
+	{
+		.directory = "bicubic rectangle", .name = "rational bicubic rectangle",
+		.patch_vertices = 16, .stride = 3, .attribute = { { 0, 2, 0 }, { 1, 1, 2 } },
+		.vertex_count = 16, .vertex = rational_bicubic_rectangle,
+		.primitive = GL_TRIANGLES,
+		.varying = "tessCoord", .varying_size = 2,
+		.rational = 1,
+	},
+	{
+		.directory = "cubic triangle", .name = "rational cubic triangle",
+		.patch_vertices = 10, .stride = 3, .attribute = { { 0, 2, 0 }, { 1, 1, 2 } },
+		.vertex_count = 10, .vertex = rational_cubic_triangle,
+		.primitive = GL_TRIANGLES,
+		.varying = "barycoordinates", .varying_size = 3,
+		.rational = 1,
+	},
+};
+
+struct options
+{
+	const char* root;
+	const char* filter;
+	const char* cache;
+	int patches;
+	int frames;
+	int level_count;
+	GLfloat level[MAX_LEVELS];
+	int pixel_error_count;
+	GLfloat pixel_error[MAX_PIXEL_ERRORS];
+	int submission_count;
+	enum submission submission[SUBMISSIONS];
+	int evaluation_count;
+	enum evaluation evaluation[EVALUATIONS];
+	// Fraction of the copies edited (so re-tessellated) each frame by the 'feedback' submission.
+	GLfloat edited;
+	// Threads for the CPU tessellator when checking parity instead of benchmarking, zero to benchmark.
+	int verify;
+};
+
+static double now()
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+
+	return ts.tv_sec + 1e-9 * ts.tv_nsec;
+}
+
+int init_egl()
+{
+	EGLDisplay display = EGL_NO_DISPLAY;
+
+	PFNEGLGETPLATFORMDISPLAYEXTPROC get_platform_display =
+		(PFNEGLGETPLATFORMDISPLAYEXTPROC)eglGetProcAddress("eglGetPlatformDisplayEXT");
+
+	if (get_platform_display)
+		display = get_platform_display(EGL_PLATFORM_SURFACELESS_MESA, EGL_DEFAULT_DISPLAY, NULL);
+
+	if (display == EGL_NO_DISPLAY)
+		display = eglGetDisplay(EGL_DEFAULT_DISPLAY);
+
+	if (!eglInitialize(display, NULL, NULL) || !eglBindAPI(EGL_OPENGL_API))
+	{
+		fprintf(stderr, "could not initialize egl: 0x%x\n", eglGetError());
+		return 1;
+	}
+
+	const EGLint context_attributes[] = {
+		EGL_CONTEXT_MAJOR_VERSION, 4,
+		EGL_CONTEXT_MINOR_VERSION, 3,
+		EGL_CONTEXT_OPENGL_PROFILE_MASK, EGL_CONTEXT_OPENGL_CORE_PROFILE_BIT,
+		EGL_NONE
+	};
+
+	EGLContext context = eglCreateContext(display, EGL_NO_CONFIG_KHR, EGL_NO_CONTEXT, context_attributes);
+
+	if (context == EGL_NO_CONTEXT || !eglMakeCurrent(display, EGL_NO_SURFACE, EGL_NO_SURFACE, context))
+	{
+		fprintf(stderr, "OpenGL context could not be created! EGL Error: 0x%x\n", eglGetError());
+		return 1;
+	}
+
+	return 0;
+}
+
+int init_framebuffer()
+{
+	GLuint FBO = 0;
+	GLuint RBO = 0;
+
+	glGenRenderbuffers(1, &RBO);
+	glBindRenderbuffer(GL_RENDERBUFFER, RBO);
+	glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	glGenFramebuffers(1, &FBO);
+	glBindFramebuffer(GL_FRAMEBUFFER, FBO);
+	glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER, RBO);
+
+	if (glCheckFramebufferStatus(GL_FRAMEBUFFER) != GL_FRAMEBUFFER_COMPLETE)
+	{
+		fprintf(stderr, "Framebuffer incomplete!\n");
+		return 1;
+	}
+
+	glViewport(0, 0, SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	return 0;
+}
+
+static const struct
+{
+	const char* file;
+	GLenum type;
+} stages[] = {
+	{ "vertex.glsl", GL_VERTEX_SHADER },
+	{ "fragment.glsl", GL_FRAGMENT_SHADER },
+	{ "tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER },
+	{ "tessellation_control.glsl", GL_TESS_CONTROL_SHADER },
+};
+
+#define STAGES (sizeof(stages) / sizeof(stages[0]))
+
+char* read_file(const char* path)
+{
+	FILE* stream = fopen(path, "rb");
+
+	if (!stream)
+	{
+		fprintf(stderr, "Unable to read: %s\n", path);
+		return NULL;
+	}
+
+	fseek(stream, 0L, SEEK_END);
+	unsigned long fileSize = ftell(stream);
+	fseek(stream, 0L, SEEK_SET);
+
+	char* contents = malloc(fileSize + 1);
+
+	if (!contents)
+	{
+		fprintf(stderr, "Unable to allocate memory to read: %s\n", path);
+		fclose(stream);
+
+		return NULL;
+	}
+
+	const size_t size = fread(contents, 1, fileSize, stream);
+	contents[size] = 0;
+
+	fclose(stream);
+
+	return contents;
+}
+
+int attach_shader(GLuint program, const char* path, const char* contents, GLenum type)
+{
+	GLuint shader = glCreateShader(type);
+
+	glShaderSource(shader, 1, (const GLchar * []) { contents }, NULL);
+	glCompileShader(shader);
+
+	GLint shader_status = GL_FALSE;
+	glGetShaderiv(shader, GL_COMPILE_STATUS, &shader_status);
+
+	if (shader_status != GL_TRUE)
+	{
+		GLchar log[1024];
+		glGetShaderInfoLog(shader, sizeof(log), NULL, log);
+
+		fprintf(stderr, "Unable to compile %s!\n%s\n", path, log);
+		glDeleteShader(shader);
+
+		return 1;
+	}
+
+	glAttachShader(program, shader);
+	glDeleteShader(shader);
+
+	return 0;
+}
+
+// 64 bit FNV-1a, including the terminating zero so consecutive strings can't run together.
+static unsigned long long hash_string(unsigned long long hash, const char* string)
+{
+	do
+	{
+		hash ^= (unsigned char)*string;
+		hash *= 0x100000001b3ULL;
+	} while (*string++);
+
+	return hash;
+}
+
+// Cached programs are named by a hash of their sources and the driver's strings, so editing a shader or updating the driver misses the cache.
+// The file holds the binary's format followed by the binary.
+static int load_program_binary(GLuint program, const char* path)
+{
+	FILE* stream = fopen(path, "rb");
+
+	if (!stream)
+		return 1;
+
+	GLenum format = 0;
+	fseek(stream, 0L, SEEK_END);
+	const long size = ftell(stream) - (long)sizeof(format);
+	fseek(stream, 0L, SEEK_SET);
+
+	void* binary = size > 0 ? malloc(size) : NULL;
+	const int read = binary && fread(&format, sizeof(format), 1, stream) == 1 && fread(binary, 1, size, stream) == (size_t)size;
+
+	fclose(stream);
+
+	GLint status = GL_FALSE;
+
+	if (read)
+	{
+		glProgramBinary(program, format, binary, (GLsizei)size);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+	}
+
+	free(binary);
+
+	return status != GL_TRUE;
+}
+
+static void save_program_binary(GLuint program, const char* path)
+{
+	GLint size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+	void* binary = size > 0 ? malloc(size) : NULL;
+
+	if (!binary)
+		return;
+
+	GLenum format = 0;
+	glGetProgramBinary(program, size, &size, &format, binary);
+
+	FILE* stream = fopen(path, "wb");
+
+	if (stream)
+	{
+		if (fwrite(&format, sizeof(format), 1, stream) != 1 || fwrite(binary, 1, size, stream) != (size_t)size)
+			fprintf(stderr, "Unable to write: %s\n", path);
+
+		fclose(stream);
+	}
+	else
+		fprintf(stderr, "Unable to write: %s\n", path);
+
+	free(binary);
+}
+
+// Links the demonstration's program, loading it from options->cache when there and valid and otherwise compiling the sources (and caching the result).
+// 'cache' is set to "disabled", "hit" or "miss".
+GLuint init_program(const struct options* options, const struct demo* demo, const char** cache)
+{
+	GLuint program = glCreateProgram();
+
+	char path[STAGES][1024];
+	char* source[STAGES] = { 0 };
+	int failed = 0;
+
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+
+	hash = hash_string(hash, (const char*)glGetString(GL_VENDOR));
+	hash = hash_string(hash, (const char*)glGetString(GL_RENDERER));
+	hash = hash_string(hash, (const char*)glGetString(GL_VERSION));
+	hash = hash_string(hash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+	hash = hash_string(hash, demo->varying);
+
+	for (size_t i = 0; i < STAGES && !failed; i++)
+	{
+		snprintf(path[i], sizeof(path[i]), "%s/%s/%s", options->root, demo->directory, stages[i].file);
+		source[i] = read_file(path[i]);
+
+		if (source[i])
+			hash = hash_string(hash, source[i]);
+		else
+			failed = 1;
+	}
+
+	char binary_path[1024];
+	snprintf(binary_path, sizeof(binary_path), "%s/%016llx.bin", options->cache ? options->cache : ".", hash);
+
+	*cache = options->cache ? "miss" : "disabled";
+
+	if (!failed && options->cache && !load_program_binary(program, binary_path))
+		*cache = "hit";
+	else if (!failed)
+	{
+		// A rejected binary leaves the program unlinked, so the sources can still be attached.
+		for (size_t i = 0; i < STAGES && !failed; i++)
+			failed = attach_shader(program, path[i], source[i], stages[i].type);
+
+		if (!failed)
+		{
+			if (options->cache)
+				glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+
+			// Capturing is only active in the 'feedback' submission, the varyings don't affect other draws.
+			glTransformFeedbackVaryings(program, 2, (const GLchar * []) { "gl_Position", demo->varying }, GL_INTERLEAVED_ATTRIBS);
+
+			glLinkProgram(program);
+
+			GLint program_link_status = GL_TRUE;
+			glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
+
+			if (program_link_status != GL_TRUE)
+			{
+				GLchar log[1024];
+				glGetProgramInfoLog(program, sizeof(log), NULL, log);
+
+				fprintf(stderr, "Error linking %s!\n%s\n", demo->directory, log);
+				failed = 1;
+			}
+			else if (options->cache)
+				save_program_binary(program, binary_path);
+		}
+	}
+
+	for (size_t i = 0; i < STAGES; i++)
+		free(source[i]);
+
+	if (failed)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+// Lays out 'patches' copies of the demonstration's patch on a square grid so the rasterized area stays roughly constant as the count grows.
+GLfloat* layout_patches(const struct demo* demo, int patches)
+{
+	const int side = (int)ceil(sqrt((double)patches));
+	const GLfloat scale = 1.0f / side;
+
+	const size_t floats = (size_t)patches * demo->vertex_count * demo->stride;
+	GLfloat* vertex = malloc(floats * sizeof(GLfloat));
+
+	for (int p = 0; p < patches; p++)
+	{
+		const GLfloat cx = -1.0f + scale * (2 * (p % side) + 1);
+		const GLfloat cy = -1.0f + scale * (2 * (p / side) + 1);
+
+		GLfloat* out = vertex + (size_t)p * demo->vertex_count * demo->stride;
+		memcpy(out, demo->vertex, demo->vertex_count * demo->stride * sizeof(GLfloat));
+
+		for (int i = 0; i < demo->vertex_count; i++)
+		{
+			GLfloat* v = out + i * demo->stride;
+
+			// Homogeneous points move by w times the offset.
+			const GLfloat w = demo->rational ? v[2] : 1.0f;
+
+			v[0] = w * cx + scale * v[0];
+			v[1] = w * cy + scale * v[1];
+
+			// Composite curves store a pair of points per vertex.
+			if (demo->stride == 4)
+			{
+				v[2] = cx + scale * v[2];
+				v[3] = cy + scale * v[3];
+			}
+
+			// Strokes' widths and distances shrink with them.
+			if (demo->stride == 7)
+			{
+				v[2] *= scale;
+				v[6] *= scale;
+			}
+		}
+	}
+
+	return vertex;
+}
+
+// Uploads the copies, returns the number of indices (or vertices if the demonstration isn't indexed) to draw.
+GLsizei upload_patches(const struct demo* demo, int patches, GLuint VBO, GLuint IBO)
+{
+	const size_t floats = (size_t)patches * demo->vertex_count * demo->stride;
+	GLfloat* vertex = layout_patches(demo, patches);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, floats * sizeof(GLfloat), vertex, GL_STATIC_DRAW);
+	free(vertex);
+
+	if (!demo->index_count)
+		return patches * demo->vertex_count;
+
+	const size_t indices = (size_t)patches * demo->index_count;
+	GLuint* index = malloc(indices * sizeof(GLuint));
+
+	for (int p = 0; p < patches; p++)
+		for (int i = 0; i < demo->index_count; i++)
+			index[p * demo->index_count + i] = demo->index[i] + p * demo->vertex_count;
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices * sizeof(GLuint), index, GL_STATIC_DRAW);
+	free(index);
+
+	return (GLsizei)indices;
+}
+
+// Each copy's arc length table, bound to the storage buffer the cubic curves' shaders read them from.
+GLuint upload_arc_length_tables(const struct demo* demo, int patches)
+{
+	GLfloat* vertex = layout_patches(demo, patches);
+	GLfloat* table = malloc((size_t)patches * BEZIER_ARC_LENGTH_FLOATS * sizeof(GLfloat));
+	GLuint buffer = 0;
+
+	if (vertex && table && !bezier_arc_length_tables(demo->rational ? BEZIER_PATCH_RATIONAL_CUBIC_CURVE : BEZIER_PATCH_CUBIC_CURVE, patches, vertex, table))
+	{
+		glGenBuffers(1, &buffer);
+		glBindBuffer(GL_SHADER_STORAGE_BUFFER, buffer);
+		glBufferData(GL_SHADER_STORAGE_BUFFER, (size_t)patches * BEZIER_ARC_LENGTH_FLOATS * sizeof(GLfloat), table, GL_STATIC_DRAW);
+		glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, buffer);
+	}
+
+	free(table);
+	free(vertex);
+
+	return buffer;
+}
+
+// One indirect command per copy, each drawing the copy's vertices (or indices).
+void upload_commands(const struct demo* demo, int patches, GLuint buffer)
+{
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, buffer);
+
+	if (demo->index_count)
+	{
+		struct draw_elements_command* command = malloc(patches * sizeof(struct draw_elements_command));
+
+		for (int p = 0; p < patches; p++)
+			command[p] = (struct draw_elements_command){ .count = demo->index_count, .instance_count = 1, .first_index = p * demo->index_count };
+
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, patches * sizeof(struct draw_elements_command), command, GL_STATIC_DRAW);
+		free(command);
+	}
+	else
+	{
+		struct draw_arrays_command* command = malloc(patches * sizeof(struct draw_arrays_command));
+
+		for (int p = 0; p < patches; p++)
+			command[p] = (struct draw_arrays_command){ .count = demo->vertex_count, .instance_count = 1, .first = p * demo->vertex_count };
+
+		glBufferData(GL_DRAW_INDIRECT_BUFFER, patches * sizeof(struct draw_arrays_command), command, GL_STATIC_DRAW);
+		free(command);
+	}
+}
+
+// Draws the patches of copies [p, p + n).
+static void draw_patches(const struct demo* demo, int patches, GLsizei count, int p, int n)
+{
+	const GLsizei per_patch = count / patches;
+
+	if (demo->index_count)
+		glDrawElements(GL_PATCHES, n * per_patch, GL_UNSIGNED_INT, (const void*)(p * per_patch * sizeof(GLuint)));
+	else
+		glDrawArrays(GL_PATCHES, p * per_patch, n * per_patch);
+}
+
+// Draws copy p's patches, as the 'per_patch' submission does.
+static void draw_patch(const struct demo* demo, int patches, GLsizei count, int p)
+{
+	draw_patches(demo, patches, count, p, 1);
+}
+
+// Tessellation output captured with transform feedback: gl_Position and the demonstration's varying, interleaved.
+// Each copy has a slot of 'capacity' vertices in 'buffer' starting at 'first', of which 'count' are its current tessellation.
+// Slots have room to spare so an edited copy is re-tessellated in place, a copy outgrowing its slot recaptures every copy.
+// The vertices are redrawn as plain lines or triangles by 'program', the demonstration's fragment shader behind a pass through vertex shader.
+#define FEEDBACK_SLACK 0.25
+
+struct feedback
+{
+	GLuint program;
+	GLuint VAO;
+	GLuint buffer;
+	// A query's target is fixed when it's first begun, so measuring (primitives generated) and capturing (written) each have their own.
+	GLuint* query;
+	GLuint* written;
+	GLsizei floats;
+
+	GLint* first;
+	GLsizei* count;
+	GLsizei* capacity;
+
+	// Copies are edited in turn starting from here.
+	int next;
+
+	// What to restore after redrawing.
+	GLuint tessellation_program;
+	GLuint tessellation_VAO;
+};
+
+// The demonstration's fragment shader behind a pass through vertex shader, for vertices laid out as struct feedback's. Returns 0 on failure.
+static GLuint init_redraw_program(const struct options* options, const struct demo* demo)
+{
+	GLuint program = glCreateProgram();
+
+	char vertex[512];
+	snprintf(vertex, sizeof(vertex),
+		"#version 430\n"
+		"layout(location = 0) in vec4 position;\n"
+		"layout(location = 1) in vec%d value;\n"
+		"layout(location = 0) out vec%d %s;\n"
+		"void main() { %s = value; gl_Position = position; }\n",
+		demo->varying_size, demo->varying_size, demo->varying, demo->varying);
+
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s/fragment.glsl", options->root, demo->directory);
+
+	char* fragment = read_file(path);
+	int failed = !fragment || attach_shader(program, "redraw vertex shader", vertex, GL_VERTEX_SHADER) || attach_shader(program, path, fragment, GL_FRAGMENT_SHADER);
+
+	free(fragment);
+
+	if (!failed)
+	{
+		glLinkProgram(program);
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+
+		if (status != GL_TRUE)
+		{
+			fprintf(stderr, "Error linking the redraw program of %s!\n", demo->directory);
+			failed = 1;
+		}
+	}
+
+	if (failed)
+	{
+		glDeleteProgram(program);
+		return 0;
+	}
+
+	return program;
+}
+
+int init_feedback(const struct options* options, const struct demo* demo, GLuint program, GLuint VAO, struct feedback* feedback)
+{
+	*feedback = (struct feedback){
+		.program = init_redraw_program(options, demo),
+		.floats = 4 + demo->varying_size,
+		.tessellation_program = program,
+		.tessellation_VAO = VAO,
+	};
+
+	if (!feedback->program)
+		return 1;
+
+	const int patches = options->patches;
+
+	feedback->query = malloc(patches * sizeof(GLuint));
+	feedback->written = malloc(patches * sizeof(GLuint));
+	feedback->first = malloc(patches * sizeof(GLint));
+	feedback->count = malloc(patches * sizeof(GLsizei));
+	feedback->capacity = malloc(patches * sizeof(GLsizei));
+
+	glGenQueries(patches, feedback->query);
+	glGenQueries(patches, feedback->written);
+	glGenBuffers(1, &feedback->buffer);
+	glGenVertexArrays(1, &feedback->VAO);
+
+	glBindVertexArray(feedback->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, feedback->buffer);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, feedback->floats * sizeof(GLfloat), NULL);
+	glVertexAttribPointer(1, demo->varying_size, GL_FLOAT, GL_FALSE, feedback->floats * sizeof(GLfloat), (const void*)(4 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+	glBindVertexArray(VAO);
+
+	return 0;
+}
+
+void free_feedback(int patches, struct feedback* feedback)
+{
+	glDeleteQueries(patches, feedback->query);
+	glDeleteQueries(patches, feedback->written);
+	glDeleteBuffers(1, &feedback->buffer);
+	glDeleteVertexArrays(1, &feedback->VAO);
+	glDeleteProgram(feedback->program);
+
+	free(feedback->query);
+	free(feedback->written);
+	free(feedback->first);
+	free(feedback->count);
+	free(feedback->capacity);
+}
+
+static GLsizei primitive_vertices(const struct demo* demo)
+{
+	return demo->primitive == GL_LINES ? 2 : 3;
+}
+
+// Re-tessellates the 'edited' copies listed in 'patch' into their slots, returns non-zero if one outgrew its slot.
+// The primitives written are read back once for the whole batch, waiting on the GPU.
+static int feedback_tessellate(const struct demo* demo, int patches, GLsizei count, struct feedback* feedback, const int* patch, int edited)
+{
+	const GLsizeiptr vertex_size = feedback->floats * sizeof(GLfloat);
+
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (int i = 0; i < edited; i++)
+	{
+		const int p = patch[i];
+
+		glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, feedback->buffer, feedback->first[p] * vertex_size, feedback->capacity[p] * vertex_size);
+		glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, feedback->written[i]);
+		glBeginTransformFeedback(demo->primitive);
+		draw_patch(demo, patches, count, p);
+		glEndTransformFeedback();
+		glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	int overflow = 0;
+
+	for (int i = 0; i < edited; i++)
+	{
+		GLuint written = 0;
+		glGetQueryObjectuiv(feedback->written[i], GL_QUERY_RESULT, &written);
+
+		const int p = patch[i];
+
+		feedback->count[p] = written * primitive_vertices(demo);
+
+		// A full slot may have dropped primitives.
+		overflow |= feedback->count[p] >= feedback->capacity[p];
+	}
+
+	return overflow;
+}
+
+// Lays out slots for the tessellation at the current uniforms and captures every copy, e.g. after the level changes.
+void feedback_capture(const struct demo* demo, int patches, GLsizei count, struct feedback* feedback)
+{
+	// Measure each copy without capturing.
+	glEnable(GL_RASTERIZER_DISCARD);
+
+	for (int p = 0; p < patches; p++)
+	{
+		glBeginQuery(GL_PRIMITIVES_GENERATED, feedback->query[p]);
+		draw_patch(demo, patches, count, p);
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+	}
+
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	const GLsizei vertices = primitive_vertices(demo);
+	GLint total = 0;
+
+	for (int p = 0; p < patches; p++)
+	{
+		GLuint generated = 0;
+		glGetQueryObjectuiv(feedback->query[p], GL_QUERY_RESULT, &generated);
+
+		feedback->first[p] = total;
+		feedback->capacity[p] = vertices * (GLsizei)(generated + ceil(FEEDBACK_SLACK * generated) + 1);
+		total += feedback->capacity[p];
+	}
+
+	glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, feedback->buffer);
+	glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, (GLsizeiptr)total * feedback->floats * sizeof(GLfloat), NULL, GL_DYNAMIC_COPY);
+
+	int* all = malloc(patches * sizeof(int));
+
+	for (int p = 0; p < patches; p++)
+		all[p] = p;
+
+	feedback_tessellate(demo, patches, count, feedback, all, patches);
+	free(all);
+}
+
+// Marks the next 'edited' copies as edited and re-tessellates them, as if their control points had been dragged.
+void feedback_edit(const struct demo* demo, int patches, GLsizei count, struct feedback* feedback, int edited)
+{
+	if (edited < 1)
+		return;
+
+	int* patch = malloc(edited * sizeof(int));
+
+	for (int i = 0; i < edited; i++)
+	{
+		patch[i] = feedback->next;
+		feedback->next = (feedback->next + 1) % patches;
+	}
+
+	if (feedback_tessellate(demo, patches, count, feedback, patch, edited))
+		feedback_capture(demo, patches, count, feedback);
+
+	free(patch);
+}
+
+// The 'compute' submission: 'program' (the directory's compute.glsl) reads the copies' control points straight from the vertex buffer
+// and evaluates each into a slot of max_level + 1 vertices in 'vertex', laid out as struct feedback's, appending its lines to 'index'
+// and counting them in 'command', which one glDrawElementsIndirect then draws with the redraw program.
+// Levels above GL_MAX_TESS_GEN_LEVEL are drawn as asked, up to max_level.
+#define COMPUTE_MAX_LEVEL 256
+#define COMPUTE_GROUP 64
+
+struct compute
+{
+	GLuint program;
+	GLuint redraw;
+	GLuint VAO;
+	GLuint vertex;
+	GLuint index;
+	GLuint command;
+	GLint max_level;
+	GLuint groups;
+
+	// What to restore after drawing.
+	GLuint tessellation_program;
+	GLuint tessellation_VAO;
+	GLuint tessellation_commands;
+};
+
+int init_compute(const struct options* options, const struct demo* demo, GLuint program, GLuint VAO, GLuint VBO, GLuint commands, struct compute* compute)
+{
+	*compute = (struct compute){
+		.program = glCreateProgram(),
+		.redraw = init_redraw_program(options, demo),
+		.max_level = COMPUTE_MAX_LEVEL,
+		.groups = (options->patches + COMPUTE_GROUP - 1) / COMPUTE_GROUP,
+		.tessellation_program = program,
+		.tessellation_VAO = VAO,
+		.tessellation_commands = commands,
+	};
+
+	for (int i = 0; i < options->level_count; i++)
+		if (options->level[i] > compute->max_level)
+			compute->max_level = (GLint)ceil(options->level[i]);
+
+	char path[1024];
+	snprintf(path, sizeof(path), "%s/%s/compute.glsl", options->root, demo->directory);
+
+	char* source = read_file(path);
+	int failed = !compute->redraw || !source || attach_shader(compute->program, path, source, GL_COMPUTE_SHADER);
+
+	free(source);
+
+	if (!failed)
+	{
+		glLinkProgram(compute->program);
+
+		GLint status = GL_FALSE;
+		glGetProgramiv(compute->program, GL_LINK_STATUS, &status);
+
+		if (status != GL_TRUE)
+		{
+			fprintf(stderr, "Error linking the compute program of %s!\n", demo->directory);
+			failed = 1;
+		}
+	}
+
+	if (failed)
+	{
+		glDeleteProgram(compute->program);
+		glDeleteProgram(compute->redraw);
+		return 1;
+	}
+
+	glProgramUniform2f(compute->program, glGetUniformLocation(compute->program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+	glProgramUniform1i(compute->program, glGetUniformLocation(compute->program, "max_level"), compute->max_level);
+	glProgramUniform1i(compute->program, glGetUniformLocation(compute->program, "patches"), options->patches);
+	glProgramUniform1i(compute->program, glGetUniformLocation(compute->program, "stride"), demo->stride);
+
+	const GLsizeiptr slots = (GLsizeiptr)options->patches * (compute->max_level + 1);
+	const GLsizei floats = 4 + demo->varying_size;
+
+	glGenBuffers(1, &compute->vertex);
+	glGenBuffers(1, &compute->index);
+	glGenBuffers(1, &compute->command);
+	glGenVertexArrays(1, &compute->VAO);
+
+	glBindVertexArray(compute->VAO);
+	glBindBuffer(GL_ARRAY_BUFFER, compute->vertex);
+	glBufferData(GL_ARRAY_BUFFER, slots * floats * sizeof(GLfloat), NULL, GL_DYNAMIC_COPY);
+	glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, floats * sizeof(GLfloat), NULL);
+	glVertexAttribPointer(1, demo->varying_size, GL_FLOAT, GL_FALSE, floats * sizeof(GLfloat), (const void*)(4 * sizeof(GLfloat)));
+	glEnableVertexAttribArray(0);
+	glEnableVertexAttribArray(1);
+
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, compute->index);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, slots * 2 * sizeof(GLuint), NULL, GL_DYNAMIC_COPY);
+
+	const struct draw_elements_command command = { .instance_count = 1 };
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, compute->command);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), &command, GL_DYNAMIC_COPY);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, commands);
+
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 1, VBO);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 2, compute->vertex);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 3, compute->index);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 4, compute->command);
+
+	glBindVertexArray(VAO);
+
+	return 0;
+}
+
+void free_compute(struct compute* compute)
+{
+	glDeleteBuffers(1, &compute->vertex);
+	glDeleteBuffers(1, &compute->index);
+	glDeleteBuffers(1, &compute->command);
+	glDeleteVertexArrays(1, &compute->VAO);
+	glDeleteProgram(compute->program);
+	glDeleteProgram(compute->redraw);
+}
+
+// Evaluates every copy and draws the lines, the dispatch's writes made visible to the draw reading them.
+static void compute_draw(const struct demo* demo, const struct compute* compute)
+{
+	const GLuint zero = 0;
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, compute->command);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(zero), &zero);
+
+	glUseProgram(compute->program);
+	glDispatchCompute(compute->groups, 1, 1);
+	// The update bit orders the next frame's glBufferSubData zeroing the count after this dispatch's atomics.
+	glMemoryBarrier(GL_VERTEX_ATTRIB_ARRAY_BARRIER_BIT | GL_ELEMENT_ARRAY_BARRIER_BIT | GL_COMMAND_BARRIER_BIT | GL_BUFFER_UPDATE_BARRIER_BIT);
+
+	glUseProgram(compute->redraw);
+	glBindVertexArray(compute->VAO);
+	glDrawElementsIndirect(demo->primitive, GL_UNSIGNED_INT, NULL);
+
+	glBindVertexArray(compute->tessellation_VAO);
+	glUseProgram(compute->tessellation_program);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, compute->tessellation_commands);
+}
+
+void draw(const struct demo* demo, int patches, GLsizei count, enum submission submission, const struct feedback* feedback, const struct compute* compute)
+{
+	glClear(GL_COLOR_BUFFER_BIT);
+
+	if (submission == SUBMIT_FEEDBACK)
+	{
+		glUseProgram(feedback->program);
+		glBindVertexArray(feedback->VAO);
+		glMultiDrawArrays(demo->primitive, feedback->first, feedback->count, patches);
+		glBindVertexArray(feedback->tessellation_VAO);
+		glUseProgram(feedback->tessellation_program);
+	}
+	else if (submission == SUBMIT_COMPUTE)
+		compute_draw(demo, compute);
+	else if (submission == SUBMIT_PER_PATCH)
+	{
+		for (int p = 0; p < patches; p++)
+			draw_patch(demo, patches, count, p);
+	}
+	else if (submission == SUBMIT_INDIRECT)
+	{
+		if (demo->index_count)
+			glMultiDrawElementsIndirect(GL_PATCHES, GL_UNSIGNED_INT, NULL, patches, 0);
+		else
+			glMultiDrawArraysIndirect(GL_PATCHES, NULL, patches, 0);
+	}
+	else if (demo->index_count)
+		glDrawElements(GL_PATCHES, count, GL_UNSIGNED_INT, NULL);
+	else
+		glDrawArrays(GL_PATCHES, 0, count);
+}
+
+static int compare_double(const void* a, const void* b)
+{
+	const double x = *(const double*)a;
+	const double y = *(const double*)b;
+
+	return (x > y) - (x < y);
+}
+
+static double percentile(const double* sorted, int count, double p)
+{
+	const int i = (int)ceil(p * count) - 1;
+
+	return sorted[i < 0 ? 0 : i];
+}
+
+// Captures every copy's tessellated vertices with transform feedback (gl_Position then the varying), the GL keeps the copies' primitives in order.
+// The copies are captured a range at a time, llvmpipe returns the wrong vertices past about 100k primitives in one draw.
+// Returns them to be freed, or NULL if out of memory.
+#define CAPTURE_PRIMITIVES 65536
+
+static GLfloat* capture(const struct demo* demo, int patches, GLsizei count, GLuint* primitives)
+{
+	const size_t bytes_per_primitive = (size_t)primitive_vertices(demo) * (4 + demo->varying_size) * sizeof(GLfloat);
+
+	GLuint query = 0;
+	glGenQueries(1, &query);
+	glEnable(GL_RASTERIZER_DISCARD);
+	glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+	draw(demo, patches, count, SUBMIT_SINGLE, NULL, NULL);
+	glEndQuery(GL_PRIMITIVES_GENERATED);
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT, primitives);
+	glDeleteQueries(1, &query);
+
+	GLuint buffer = 0;
+	glGenBuffers(1, &buffer);
+	glBindBuffer(GL_TRANSFORM_FEEDBACK_BUFFER, buffer);
+	glBufferData(GL_TRANSFORM_FEEDBACK_BUFFER, *primitives * bytes_per_primitive, NULL, GL_STATIC_READ);
+
+	// The copies are the same patch scaled, so they tessellate alike.
+	const GLuint per_patch = (*primitives + patches - 1) / patches;
+	const int chunk = per_patch ? (int)fmax(1, CAPTURE_PRIMITIVES / per_patch) : patches;
+
+	GLuint written = 0;
+	glGenQueries(1, &query);
+
+	for (int p = 0; p < patches && written < *primitives; p += chunk)
+	{
+		const int n = patches - p < chunk ? patches - p : chunk;
+
+		glBindBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, buffer, written * bytes_per_primitive, (*primitives - written) * bytes_per_primitive);
+		glBeginQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN, query);
+		glBeginTransformFeedback(demo->primitive);
+		draw_patches(demo, patches, count, p, n);
+		glEndTransformFeedback();
+		glEndQuery(GL_TRANSFORM_FEEDBACK_PRIMITIVES_WRITTEN);
+
+		GLuint chunk_written = 0;
+		glGetQueryObjectuiv(query, GL_QUERY_RESULT, &chunk_written);
+		written += chunk_written;
+	}
+
+	glDeleteQueries(1, &query);
+	glDisable(GL_RASTERIZER_DISCARD);
+
+	GLfloat* vertex = malloc(*primitives * bytes_per_primitive + 1);
+	const GLfloat* mapped = glMapBufferRange(GL_TRANSFORM_FEEDBACK_BUFFER, 0, *primitives * bytes_per_primitive, GL_MAP_READ_BIT);
+
+	if (vertex && mapped)
+		memcpy(vertex, mapped, *primitives * bytes_per_primitive);
+
+	if (mapped)
+		glUnmapBuffer(GL_TRANSFORM_FEEDBACK_BUFFER);
+
+	glDeleteBuffers(1, &buffer);
+
+	if (!mapped)
+	{
+		free(vertex);
+		return NULL;
+	}
+
+	return vertex;
+}
+
+// Largest distance in pixels between the vertices of the current evaluation and de Casteljau's, both tessellate the same way.
+static double evaluation_error(const struct demo* demo, GLuint program, int patches, GLsizei count)
+{
+	const GLsizei floats = 4 + demo->varying_size;
+	GLuint primitives = 0, reference_primitives = 0;
+
+	GLfloat* vertex = capture(demo, patches, count, &primitives);
+
+	glUniform1i(glGetUniformLocation(program, "power_basis"), 0);
+	GLfloat* reference = capture(demo, patches, count, &reference_primitives);
+	glUniform1i(glGetUniformLocation(program, "power_basis"), 1);
+
+	double error = vertex && reference && primitives == reference_primitives ? 0 : INFINITY;
+
+	for (size_t i = 0; isfinite(error) && i < (size_t)primitives * primitive_vertices(demo); i++)
+	{
+		const GLfloat* a = vertex + i * floats;
+		const GLfloat* b = reference + i * floats;
+		const double dx = 0.5 * SCREEN_WIDTH * (a[0] / a[3] - b[0] / b[3]);
+		const double dy = 0.5 * SCREEN_HEIGHT * (a[1] / a[3] - b[1] / b[3]);
+
+		error = fmax(error, sqrt(dx * dx + dy * dy));
+	}
+
+	free(reference);
+	free(vertex);
+
+	return error;
+}
+
+// Largest distance in pixels between the captured lines and the curve, measured at points between each line's parameters.
+// Every copy is the demonstration's curve scaled down (see layout_patches) so the parameters are evaluated on it and the distance scaled.
+static double chord_error(const struct demo* demo, int patches, GLsizei count)
+{
+	const GLsizei floats = 4 + demo->varying_size;
+	const int side = (int)ceil(sqrt((double)patches));
+	GLuint primitives = 0;
+
+	GLfloat* vertex = capture(demo, patches, count, &primitives);
+
+	// The ends and 7 points between them.
+	const int points = 9;
+	const size_t samples = (size_t)primitives * points;
+
+	float* t = malloc(samples * sizeof(float));
+	float* x = malloc(samples * sizeof(float));
+	float* y = malloc(samples * sizeof(float));
+
+	double error = vertex && t && x && y ? 0 : INFINITY;
+
+	for (size_t i = 0; isfinite(error) && i < primitives; i++)
+	{
+		const GLfloat t0 = vertex[2 * i * floats + 4];
+		const GLfloat t1 = vertex[(2 * i + 1) * floats + 4];
+
+		for (int j = 0; j < points; j++)
+			t[i * points + j] = t0 + (t1 - t0) * j / (points - 1);
+	}
+
+	if (isfinite(error))
+	{
+		if (demo->rational)
+			bezier_rational_cubic_curve(demo->vertex, samples, t, x, y);
+		else
+			bezier_cubic_curve(demo->vertex, samples, t, x, y);
+	}
+
+	for (size_t i = 0; isfinite(error) && i < primitives; i++)
+	{
+		const float* px = x + i * points;
+		const float* py = y + i * points;
+		const double dx = px[points - 1] - px[0], dy = py[points - 1] - py[0];
+		const double length = sqrt(dx * dx + dy * dy);
+
+		for (int j = 1; j < points - 1; j++)
+		{
+			const double ex = px[j] - px[0], ey = py[j] - py[0];
+			const double distance = length > 0 ? fabs(dx * ey - dy * ex) / length : sqrt(ex * ex + ey * ey);
+
+			error = fmax(error, 0.5 * SCREEN_WIDTH * distance / side);
+		}
+	}
+
+	free(y);
+	free(x);
+	free(t);
+	free(vertex);
+
+	return error;
+}
+
+// A positive level fixes every patch's level, otherwise the control shader picks them for the pixel error.
+// The 'feedback' submission captures every copy before the first frame, then each frame re-tessellates the edited copies and redraws them all.
+void run(const struct options* options, const struct demo* demo, GLuint program, GLsizei count, enum submission submission, enum evaluation evaluation, GLfloat level, GLfloat pixel_error, struct feedback* feedback, const struct compute* compute, int* first)
+{
+	glUniform1f(glGetUniformLocation(program, "level"), level);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+
+	if (submission == SUBMIT_COMPUTE)
+	{
+		glProgramUniform1f(compute->program, glGetUniformLocation(compute->program, "level"), level);
+		glProgramUniform1f(compute->program, glGetUniformLocation(compute->program, "pixel_error"), pixel_error);
+	}
+
+	glUniform1i(glGetUniformLocation(program, "power_basis"), evaluation == EVALUATE_POWER);
+	glUniform1i(glGetUniformLocation(program, "arc_length"), evaluation == EVALUATE_ARC_LENGTH);
+
+	// The curve demos are those with the arc length table, their de Casteljau rows measure the same chord error as a baseline.
+	// The capture is the tessellation shaders', so the compute rows are left out.
+	const int curve = glGetUniformLocation(program, "arc_length") >= 0;
+
+	const double error = evaluation == EVALUATE_POWER ? evaluation_error(demo, program, options->patches, count) :
+		evaluation == EVALUATE_ARC_LENGTH || (evaluation == EVALUATE_CASTELJAU && curve && submission != SUBMIT_COMPUTE) ? chord_error(demo, options->patches, count) : 0;
+
+	const int edited = submission == SUBMIT_FEEDBACK ? (int)ceil(options->edited * options->patches) : 0;
+
+	if (submission == SUBMIT_FEEDBACK)
+		feedback_capture(demo, options->patches, count, feedback);
+
+	// Count what the tessellator emitted in an untimed frame so the query doesn't perturb the timings.
+	GLuint query = 0;
+	GLuint primitives = 0;
+
+	glGenQueries(1, &query);
+	glBeginQuery(GL_PRIMITIVES_GENERATED, query);
+	draw(demo, options->patches, count, submission, feedback, compute);
+	glEndQuery(GL_PRIMITIVES_GENERATED);
+	glGetQueryObjectuiv(query, GL_QUERY_RESULT, &primitives);
+	glDeleteQueries(1, &query);
+
+	for (int i = 0; i < WARMUP_FRAMES; i++)
+	{
+		if (submission == SUBMIT_FEEDBACK)
+			feedback_edit(demo, options->patches, count, feedback, edited);
+
+		draw(demo, options->patches, count, submission, feedback, compute);
+	}
+
+	glFinish();
+
+	double* frame = malloc(options->frames * sizeof(double));
+	double total = 0;
+
+	for (int i = 0; i < options->frames; i++)
+	{
+		const double start = now();
+
+		if (submission == SUBMIT_FEEDBACK)
+			feedback_edit(demo, options->patches, count, feedback, edited);
+
+		draw(demo, options->patches, count, submission, feedback, compute);
+		glFinish();
+
+		frame[i] = now() - start;
+		total += frame[i];
+	}
+
+	qsort(frame, options->frames, sizeof(double), compare_double);
+
+	const double mean = total / options->frames;
+	const double vertices = (double)primitives * (demo->primitive == GL_LINES ? 2 : 3);
+
+	// Primitives are those redrawn, not the edited copies' re-tessellation.
+	printf("%s\n\t\t{\"demo\": \"%s\", \"patches\": %d, \"submission\": \"%s\", \"draw_calls\": %d, \"edited\": %d, \"evaluation\": \"%s\", \"max_error_px\": %.3g, "
+		"\"mode\": \"%s\", \"level\": %g, \"pixel_error\": %g, \"primitives\": %u, \"vertices\": %.0f, "
+		"\"patches_per_sec\": %.1f, \"vertices_per_sec\": %.1f, "
+		"\"frame_ms\": {\"mean\": %.4f, \"p50\": %.4f, \"p90\": %.4f, \"p99\": %.4f, \"max\": %.4f}}",
+		*first ? "" : ",",
+		demo_name(demo), options->patches, submission_name[submission], submission == SUBMIT_PER_PATCH ? options->patches : 1 + edited, edited, evaluation_name[evaluation], error, level > 0 ? "fixed" : "adaptive", level, level > 0 ? 0.0f : pixel_error, primitives, vertices,
+		options->patches / mean, vertices / mean,
+		1e3 * mean,
+		1e3 * percentile(frame, options->frames, 0.5),
+		1e3 * percentile(frame, options->frames, 0.9),
+		1e3 * percentile(frame, options->frames, 0.99),
+		1e3 * frame[options->frames - 1]);
+
+	*first = 0;
+	free(frame);
+}
+
+// Demonstrations the CPU tessellator reproduces (by name), see bezier_tessellate.
+static const struct
+{
+	const char* name;
+	enum bezier_patch type;
+} tessellated[] = {
+	{ "cubic curve", BEZIER_PATCH_CUBIC_CURVE },
+	{ "bicubic rectangle", BEZIER_PATCH_BICUBIC_RECTANGLE },
+	{ "cubic triangle", BEZIER_PATCH_CUBIC_TRIANGLE },
+	{ "conic section", BEZIER_PATCH_RATIONAL_QUADRATIC },
+	{ "rational cubic curve", BEZIER_PATCH_RATIONAL_CUBIC_CURVE },
+	{ "rational bicubic rectangle", BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE },
+	{ "rational cubic triangle", BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE },
+};
+
+// Tessellators may place vertices in fixed point (Mesa's, like Direct3D's reference, uses 16.16 and is up to about 1e-4 out at level 64),
+// so gl_TessCoord is matched to well within the closest spacing of vertices and positions to a fraction of a pixel.
+#define PARITY_COORDINATE 5e-4
+#define PARITY_PIXELS 5e-2
+
+static int compare_u(const void* a, const void* b)
+{
+	const float x = *(const float*)a;
+	const float y = *(const float*)b;
+
+	return (x > y) - (x < y);
+}
+
+// Signed area in the (u,v) plane, positive for counter-clockwise triangles.
+static double triangle_area(const GLfloat* a, const GLfloat* b, const GLfloat* c)
+{
+	return 0.5 * ((b[0] - a[0]) * (c[1] - a[1]) - (c[0] - a[0]) * (b[1] - a[1]));
+}
+
+// Compares bezier_tessellate against the demonstration's transform feedback capture at a fixed level.
+// The GL only defines where the vertices are, so each copy must have as many primitives, use the same vertices (matched by gl_TessCoord)
+// at the same positions and cover the same area with counter-clockwise triangles.
+int parity(const struct options* options, const struct demo* demo, enum bezier_patch type, GLuint program, GLsizei count, GLfloat level, int* first)
+{
+	const int patches = options->patches;
+	const int vertices = primitive_vertices(demo);
+	const GLsizei floats = 4 + demo->varying_size;
+
+	glUniform1f(glGetUniformLocation(program, "level"), level);
+
+	GLuint primitives = 0;
+	GLfloat* gpu = capture(demo, patches, count, &primitives);
+
+	// The CPU tessellator takes the control points the evaluation shader sees.
+	GLfloat* layout = layout_patches(demo, patches);
+	const int patch_floats = bezier_patch_floats(type);
+	float* patch = malloc((size_t)patches * patch_floats * sizeof(float));
+	struct bezier_levels* levels = malloc(patches * sizeof(struct bezier_levels));
+
+	for (int p = 0; p < patches; p++)
+	{
+		const GLfloat* in = layout + (size_t)p * demo->vertex_count * demo->stride;
+		float* out = patch + (size_t)p * patch_floats;
+
+		memcpy(out, in, patch_floats * sizeof(float));
+
+		// As the control shaders use the 'level' uniform.
+		if (vertices == 2)
+			levels[p] = (struct bezier_levels){ .outer = { 1, level } };
+		else
+			levels[p] = (struct bezier_levels){ .outer = { level, level, level, level }, .inner = { level, level } };
+	}
+
+	struct bezier_arena arena;
+	struct bezier_mesh mesh = { 0 };
+	const size_t bytes = (size_t)primitives * vertices * (BEZIER_VERTEX_FLOATS * sizeof(float) + sizeof(unsigned int)) + (size_t)patches * (2 * sizeof(size_t) + 64) + (1 << 20);
+
+	const int failed = bezier_arena_init(&arena, 4 * bytes) || bezier_tessellate(type, patches, patch, levels, options->verify, &arena, &mesh);
+
+	size_t unmatched = 0, unused = 0;
+	double position_error = 0, gpu_area = 0, cpu_area = 0;
+	int counts = 1, clockwise = 0;
+
+	float* sorted = NULL;
+	char* used = NULL;
+
+	if (!failed && gpu)
+	{
+		size_t largest = 0;
+
+		for (int p = 0; p < patches; p++)
+			if (mesh.vertex_offset[p + 1] - mesh.vertex_offset[p] > largest)
+				largest = mesh.vertex_offset[p + 1] - mesh.vertex_offset[p];
+
+		// Each copy's CPU vertices sorted by u, as (u, index) pairs.
+		sorted = malloc(2 * largest * sizeof(float));
+		used = malloc(largest);
+	}
+
+	const GLuint per_patch = primitives / patches;
+
+	for (int p = 0; sorted && used && p < patches; p++)
+	{
+		const size_t base = mesh.vertex_offset[p];
+		const size_t n = mesh.vertex_offset[p + 1] - base;
+
+		counts &= per_patch * vertices == mesh.index_offset[p + 1] - mesh.index_offset[p] && primitives % patches == 0;
+
+		for (size_t i = 0; i < n; i++)
+		{
+			sorted[2 * i] = mesh.vertex[BEZIER_VERTEX_FLOATS * (base + i) + 2];
+			sorted[2 * i + 1] = (float)i;
+		}
+
+		qsort(sorted, n, 2 * sizeof(float), compare_u);
+		memset(used, 0, n);
+
+		const GLfloat* g = gpu + (size_t)p * per_patch * vertices * floats;
+
+		for (GLuint k = 0; k < per_patch * vertices; k++, g += floats)
+		{
+			const GLfloat* coordinate = g + 4;
+			size_t low = 0, high = n;
+
+			while (low < high)
+			{
+				const size_t mid = (low + high) / 2;
+
+				if (sorted[2 * mid] < coordinate[0] - PARITY_COORDINATE)
+					low = mid + 1;
+				else
+					high = mid;
+			}
+
+			long match = -1;
+
+			for (size_t i = low; i < n && sorted[2 * i] <= coordinate[0] + PARITY_COORDINATE && match < 0; i++)
+			{
+				const float* c = mesh.vertex + BEZIER_VERTEX_FLOATS * (base + (size_t)sorted[2 * i + 1]) + 2;
+				int same = 1;
+
+				for (int d = 1; d < demo->varying_size; d++)
+					same &= fabsf(c[d] - coordinate[d]) <= PARITY_COORDINATE;
+
+				if (same)
+					match = (long)sorted[2 * i + 1];
+			}
+
+			if (match < 0)
+			{
+				unmatched++;
+				continue;
+			}
+
+			used[match] = 1;
+
+			const float* c = mesh.vertex + BEZIER_VERTEX_FLOATS * (base + match);
+			const double dx = 0.5 * SCREEN_WIDTH * (g[0] / g[3] - c[0]);
+			const double dy = 0.5 * SCREEN_HEIGHT * (g[1] / g[3] - c[1]);
+
+			position_error = fmax(position_error, sqrt(dx * dx + dy * dy));
+		}
+
+		for (size_t i = 0; i < n; i++)
+			unused += !used[i];
+
+		if (vertices == 3)
+		{
+			const GLfloat* t = gpu + (size_t)p * per_patch * vertices * floats;
+
+			for (GLuint k = 0; k < per_patch; k++, t += 3 * floats)
+			{
+				const double area = triangle_area(t + 4, t + floats + 4, t + 2 * floats + 4);
+
+				gpu_area += area;
+				clockwise += area < 0;
+			}
+
+			for (size_t i = mesh.index_offset[p]; i < mesh.index_offset[p + 1]; i += 3)
+				cpu_area += triangle_area(mesh.vertex + BEZIER_VERTEX_FLOATS * mesh.index[i] + 2,
+					mesh.vertex + BEZIER_VERTEX_FLOATS * mesh.index[i + 1] + 2,
+					mesh.vertex + BEZIER_VERTEX_FLOATS * mesh.index[i + 2] + 2);
+		}
+	}
+
+	const int passed = sorted && used && counts && !unmatched && !unused && !clockwise && position_error < PARITY_PIXELS && fabs(gpu_area - cpu_area) < 1e-3 * patches;
+
+	printf("%s\n\t\t{\"demo\": \"%s\", \"patches\": %d, \"level\": %g, \"gpu_primitives\": %u, \"cpu_primitives\": %zu, \"cpu_vertices\": %zu, "
+		"\"unmatched_vertices\": %zu, \"unused_vertices\": %zu, \"max_position_error_px\": %.3g, \"gpu_area\": %.6f, \"cpu_area\": %.6f, \"passed\": %s}",
+		*first ? "" : ",",
+		demo_name(demo), patches, level, primitives, mesh.index_count / vertices, mesh.vertex_count,
+		unmatched, unused, position_error, gpu_area, cpu_area, passed ? "true" : "false");
+
+	*first = 0;
+
+	free(used);
+	free(sorted);
+	bezier_arena_free(&arena);
+	free(levels);
+	free(patch);
+	free(layout);
+	free(gpu);
+
+	return !passed;
+}
+
+// Time to a usable program, e.g. for cold (cache miss) against warm (cache hit) launches.
+struct startup
+{
+	const char* cache;
+	double ms;
+};
+
+int run_demo(const struct options* options, const struct demo* demo, struct startup* startup, int* first)
+{
+	const double start = now();
+
+	GLuint program = init_program(options, demo, &startup->cache);
+
+	if (!program)
+		return 1;
+
+	startup->ms = 1e3 * (now() - start);
+
+	GLuint VAO = 0;
+	GLuint VBO = 0;
+	GLuint IBO = 0;
+	GLuint commands = 0;
+
+	glGenVertexArrays(1, &VAO);
+	glBindVertexArray(VAO);
+
+	glGenBuffers(1, &VBO);
+	glGenBuffers(1, &IBO);
+	glGenBuffers(1, &commands);
+
+	const GLsizei count = upload_patches(demo, options->patches, VBO, IBO);
+	upload_commands(demo, options->patches, commands);
+
+	GLuint tables = 0;
+
+	if (glGetUniformLocation(program, "arc_length") >= 0)
+		tables = upload_arc_length_tables(demo, options->patches);
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+
+	for (int i = 0; i < 4 && demo->attribute[i].size; i++)
+	{
+		glVertexAttribPointer(demo->attribute[i].location, demo->attribute[i].size, GL_FLOAT, GL_FALSE,
+			demo->stride * sizeof(GLfloat), (const void*)(demo->attribute[i].offset * sizeof(GLfloat)));
+		glEnableVertexAttribArray(demo->attribute[i].location);
+	}
+
+	// Weights of the polynomial patches, see the cubic patches' vertex shaders, and the composite curve's handle ratios.
+	glVertexAttrib1f(1, 1.0f);
+	glVertexAttrib1f(2, 1.0f);
+
+	glUseProgram(program);
+	glPatchParameteri(GL_PATCH_VERTICES, demo->patch_vertices);
+
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	// Patches per copy, where the stroked path's ends are.
+	glUniform1i(glGetUniformLocation(program, "segments"), (demo->index_count ? demo->index_count : demo->vertex_count) / demo->patch_vertices);
+
+	GLint max_level = 64;
+	glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &max_level);
+
+	for (int i = 0; i < options->level_count; i++)
+		if (options->level[i] > max_level)
+			fprintf(stderr, "Level %g of %s clamped to GL_MAX_TESS_GEN_LEVEL %d\n", options->level[i], demo_name(demo), max_level);
+
+	struct feedback feedback = { 0 };
+	struct compute compute = { 0 };
+	int failed = 0;
+
+	for (size_t t = 0; options->verify && t < sizeof(tessellated) / sizeof(tessellated[0]); t++)
+		if (!strcmp(demo_name(demo), tessellated[t].name))
+			for (int i = 0; i < options->level_count; i++)
+				failed |= parity(options, demo, tessellated[t].type, program, count, fminf(options->level[i], (GLfloat)max_level), first);
+
+	for (int s = 0; s < options->submission_count && !options->verify; s++)
+	{
+		const enum submission submission = options->submission[s];
+
+		if (submission == SUBMIT_COMPUTE && !demo->compute)
+			continue;
+
+		if ((submission == SUBMIT_FEEDBACK && init_feedback(options, demo, program, VAO, &feedback)) ||
+			(submission == SUBMIT_COMPUTE && init_compute(options, demo, program, VAO, VBO, commands, &compute)))
+		{
+			failed = 1;
+			continue;
+		}
+
+		for (int e = 0; e < options->evaluation_count; e++)
+		{
+			if (evaluation_uniform[options->evaluation[e]] && glGetUniformLocation(program, evaluation_uniform[options->evaluation[e]]) < 0)
+				continue;
+
+			// The compute shaders only evaluate with de Casteljau's.
+			if (submission == SUBMIT_COMPUTE && options->evaluation[e] != EVALUATE_CASTELJAU)
+				continue;
+
+			// Only the tessellator's levels are capped.
+			for (int i = 0; i < options->level_count; i++)
+				run(options, demo, program, count, submission, options->evaluation[e], submission == SUBMIT_COMPUTE ? options->level[i] : fminf(options->level[i], (GLfloat)max_level), 0, &feedback, &compute, first);
+
+			for (int i = 0; i < options->pixel_error_count; i++)
+				run(options, demo, program, count, submission, options->evaluation[e], 0, options->pixel_error[i], &feedback, &compute, first);
+		}
+
+		glUniform1i(glGetUniformLocation(program, "power_basis"), 0);
+		glUniform1i(glGetUniformLocation(program, "arc_length"), 0);
+
+		if (submission == SUBMIT_FEEDBACK)
+			free_feedback(options->patches, &feedback);
+
+		if (submission == SUBMIT_COMPUTE)
+			free_compute(&compute);
+	}
+
+	glUseProgram(0);
+	glDeleteBuffers(1, &tables);
+	glDeleteBuffers(1, &commands);
+	glDeleteBuffers(1, &IBO);
+	glDeleteBuffers(1, &VBO);
+	glDeleteVertexArrays(1, &VAO);
+	glDeleteProgram(program);
+
+	return failed || glGetError() != GL_NO_ERROR;
+}
+
+// Comma separated list of positive numbers, an empty list skips that sweep.
+int parse_list(const char* value, GLfloat* list, int capacity, int* count)
+{
+	*count = 0;
+
+	for (char* end = (char*)value; *value && *count < capacity; value = end + (*end == ','))
+	{
+		list[*count] = strtof(value, &end);
+
+		if (end == value || list[(*count)++] <= 0)
+			return 1;
+	}
+
+	return 0;
+}
+
+// Index of the name the first length characters of value are, or -1.
+static int find_name(const char* value, size_t length, const char** name, int count)
+{
+	for (int i = 0; i < count; i++)
+		if (strlen(name[i]) == length && !strncmp(value, name[i], length))
+			return i;
+
+	return -1;
+}
+
+// Comma separated list of submission names.
+int parse_submissions(const char* value, struct options* options)
+{
+	options->submission_count = 0;
+
+	while (*value && options->submission_count < SUBMISSIONS)
+	{
+		const size_t length = strcspn(value, ",");
+		const int s = find_name(value, length, submission_name, SUBMISSIONS);
+
+		if (s < 0)
+			return 1;
+
+		options->submission[options->submission_count++] = s;
+		value += length + (value[length] == ',');
+	}
+
+	return options->submission_count < 1;
+}
+
+// Comma separated list of evaluation names.
+int parse_evaluations(const char* value, struct options* options)
+{
+	options->evaluation_count = 0;
+
+	while (*value && options->evaluation_count < EVALUATIONS)
+	{
+		const size_t length = strcspn(value, ",");
+		const int e = find_name(value, length, evaluation_name, EVALUATIONS);
+
+		if (e < 0)
+			return 1;
+
+		options->evaluation[options->evaluation_count++] = e;
+		value += length + (value[length] == ',');
+	}
+
+	return options->evaluation_count < 1;
+}
+
+int parse_options(int argc, char* args[], struct options* options)
+{
+	*options = (struct options){
+		.root = "..",
+		.patches = 1000,
+		.frames = 60,
+		.level_count = 7,
+		.level = { 1, 2, 4, 8, 16, 32, 64 },
+		.pixel_error_count = 3,
+		.pixel_error = { 0.25, 1, 4 },
+		.submission_count = SUBMISSIONS,
+		.submission = { SUBMIT_SINGLE, SUBMIT_PER_PATCH, SUBMIT_INDIRECT, SUBMIT_FEEDBACK, SUBMIT_COMPUTE },
+		.evaluation_count = EVALUATIONS,
+		.evaluation = { EVALUATE_CASTELJAU, EVALUATE_POWER, EVALUATE_ARC_LENGTH },
+		.edited = 0.01,
+	};
+
+	for (int i = 1; i < argc; i++)
+	{
+		if (i + 1 == argc)
+			return 1;
+
+		const char* value = args[++i];
+
+		if (!strcmp(args[i - 1], "-p"))
+			options->patches = atoi(value);
+		else if (!strcmp(args[i - 1], "-f"))
+			options->frames = atoi(value);
+		else if (!strcmp(args[i - 1], "-d"))
+			options->filter = value;
+		else if (!strcmp(args[i - 1], "-r"))
+			options->root = value;
+		else if (!strcmp(args[i - 1], "-c"))
+			options->cache = value;
+		else if (!strcmp(args[i - 1], "-u"))
+			options->edited = strtof(value, NULL);
+		else if (!strcmp(args[i - 1], "-v"))
+			options->verify = atoi(value);
+		else if (!strcmp(args[i - 1], "-l"))
+		{
+			if (parse_list(value, options->level, MAX_LEVELS, &options->level_count))
+				return 1;
+		}
+		else if (!strcmp(args[i - 1], "-e"))
+		{
+			if (parse_list(value, options->pixel_error, MAX_PIXEL_ERRORS, &options->pixel_error_count))
+				return 1;
+		}
+		else if (!strcmp(args[i - 1], "-s"))
+		{
+			if (parse_submissions(value, options))
+				return 1;
+		}
+		else if (!strcmp(args[i - 1], "-m"))
+		{
+			if (parse_evaluations(value, options))
+				return 1;
+		}
+		else
+			return 1;
+	}
+
+	return options->patches < 1 || options->frames < 1 || options->level_count + options->pixel_error_count < 1 || !(options->edited >= 0 && options->edited <= 1) || options->verify < 0;
+}
+
+int main(int argc, char* args[])
+{
+	struct options options;
+
+	if (parse_options(argc, args, &options))
+	{
+		fprintf(stderr, "usage: %s [-p patches] [-f frames] [-l level,level,...] [-e pixel_error,pixel_error,...] [-s submission,...] [-m evaluation,...] [-u edited] [-v threads] [-d demonstration] [-r root] [-c cache]\n", args[0]);
+		return 1;
+	}
+
+	if (init_egl() || init_framebuffer())
+		return 1;
+
+	GLint max_level = 0;
+	glGetIntegerv(GL_MAX_TESS_GEN_LEVEL, &max_level);
+
+	GLint binary_formats = 0;
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &binary_formats);
+
+	if (options.cache && !binary_formats)
+	{
+		fprintf(stderr, "The driver doesn't support program binaries, not caching\n");
+		options.cache = NULL;
+	}
+
+	printf("{\n\t\"renderer\": \"%s\",\n\t\"version\": \"%s\",\n\t\"max_tess_gen_level\": %d,\n\t\"program_binary_formats\": %d,"
+		"\n\t\"width\": %d,\n\t\"height\": %d,\n\t\"frames\": %d,\n\t\"results\": [",
+		glGetString(GL_RENDERER), glGetString(GL_VERSION), max_level, binary_formats, SCREEN_WIDTH, SCREEN_HEIGHT, options.frames);
+
+	const size_t demo_count = sizeof(demos) / sizeof(demos[0]);
+	struct startup startup[sizeof(demos) / sizeof(demos[0])] = { 0 };
+
+	int failures = 0;
+	int first = 1;
+
+	for (size_t i = 0; i < demo_count; i++)
+		if (!options.filter || strstr(demo_name(&demos[i]), options.filter))
+			failures += run_demo(&options, &demos[i], &startup[i], &first);
+
+	printf("\n\t],\n\t\"programs\": [");
+	first = 1;
+
+	for (size_t i = 0; i < demo_count; i++)
+		if (startup[i].cache)
+		{
+			printf("%s\n\t\t{\"demo\": \"%s\", \"cache\": \"%s\", \"ms\": %.3f}", first ? "" : ",", demo_name(&demos[i]), startup[i].cache, startup[i].ms);
+			first = 0;
+		}
+
+	printf("\n\t]\n}\n");
+
+	return failures != 0;
+}
@@ -0,0 +1,83 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <math.h>
+
+#define STEPS BEZIER_ARC_LENGTH_STEPS
+#define SAMPLES BEZIER_ARC_LENGTH_SAMPLES
+
+// Curvature of the circle through three points, 2 |a x b| / (|a| |b| |a + b|) for the chords a and b between them.
+static double circle_curvature(const float* x, const float* y)
+{
+	const double ax = x[1] - x[0], ay = y[1] - y[0];
+	const double bx = x[2] - x[1], by = y[2] - y[1];
+	const double denominator = sqrt((ax * ax + ay * ay) * (bx * bx + by * by) * ((ax + bx) * (ax + bx) + (ay + by) * (ay + by)));
+
+	return denominator > 0 ? 2 * fabs(ax * by - ay * bx) / denominator : 0;
+}
+
+static void curve_table(const float* x, const float* y, float* table)
+{
+	double length[STEPS + 1] = { 0 };
+	double curvature = 0;
+
+	for (int i = 1; i <= STEPS; i++)
+	{
+		const double dx = x[i] - x[i - 1], dy = y[i] - y[i - 1];
+		length[i] = length[i - 1] + sqrt(dx * dx + dy * dy);
+	}
+
+	for (int i = 1; i < STEPS; i++)
+		curvature = fmax(curvature, circle_curvature(x + i - 1, y + i - 1));
+
+	table[0] = (float)length[STEPS];
+	table[1] = (float)curvature;
+
+	// Walks the polyline once, inverting its length between the steps bracketing each fraction.
+	int step = 0;
+
+	for (int k = 0; k <= SAMPLES; k++)
+	{
+		const double target = length[STEPS] * k / SAMPLES;
+
+		while (step < STEPS - 1 && length[step + 1] < target)
+			step++;
+
+		const double span = length[step + 1] - length[step];
+		const double f = span > 0 ? (target - length[step]) / span : 0;
+
+		table[2 + k] = (float)((step + fmin(fmax(f, 0), 1)) / STEPS);
+	}
+
+	// Exact ends so the sampled curve still meets its neighbours.
+	table[2] = 0;
+	table[2 + SAMPLES] = 1;
+}
+
+int bezier_arc_length_tables(enum bezier_patch type, size_t count, const float* curve, float* table)
+{
+	if (type != BEZIER_PATCH_CUBIC_CURVE && type != BEZIER_PATCH_RATIONAL_CUBIC_CURVE)
+		return 1;
+
+	const int floats = bezier_patch_floats(type);
+
+	float t[STEPS + 1], x[STEPS + 1], y[STEPS + 1];
+
+	for (int i = 0; i <= STEPS; i++)
+		t[i] = (float)i / STEPS;
+
+	for (size_t c = 0; c < count; c++)
+	{
+		if (type == BEZIER_PATCH_CUBIC_CURVE)
+			bezier_cubic_curve(curve + c * floats, STEPS + 1, t, x, y);
+		else
+			bezier_rational_cubic_curve(curve + c * floats, STEPS + 1, t, x, y);
+
+		curve_table(x, y, table + c * BEZIER_ARC_LENGTH_FLOATS);
+	}
+
+	return 0;
+}
@@ -0,0 +1,299 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// CPU reference evaluation of the demonstrations' patches.
+// Control points are given exactly as the demonstrations upload them (interleaved x,y pairs in the same order),
+// while parameters and results are separate arrays (structure of arrays) so whole batches are evaluated in SIMD lanes.
+// The kernel width is chosen at compile time: AVX2 (8 lanes), SSE2 or NEON (4 lanes), otherwise scalar.
+
+#ifndef BEZIER_H
+#define BEZIER_H
+
+#include <stddef.h>
+
+// Name and lane count of the compiled kernels.
+const char* bezier_simd_name();
+int bezier_simd_width();
+
+// 'cubic curve': 4 points, parameter t in [0,1].
+void bezier_cubic_curve(const float control_point[8], size_t count, const float* t, float* x, float* y);
+
+// 'bicubic rectangle': 16 points with point i + 4j at column i and row j, parameter (u,v) is gl_TessCoord.xy.
+void bezier_bicubic_rectangle(const float control_point[32], size_t count, const float* u, const float* v, float* x, float* y);
+
+// 'cubic triangle': 10 points in rows 0 | 1,2 | 3,4,5 | 6,7,8,9, parameter (u,v,w) is gl_TessCoord (barycentric).
+void bezier_cubic_triangle(const float control_point[20], size_t count, const float* u, const float* v, const float* w, float* x, float* y);
+
+// 'conic section': 3 homogeneous points (w*x, w*y, w), the form the tessellation control shader passes on.
+void bezier_rational_quadratic(const float control_point[9], size_t count, const float* t, float* x, float* y);
+
+// Rational forms of the cubic patches, with homogeneous points (w*x, w*y, w) in the same order as the polynomial ones.
+// This is also how they are uploaded: (w*x, w*y) to location 0 and w to location 1, see the demonstrations' vertex shaders.
+void bezier_rational_cubic_curve(const float control_point[12], size_t count, const float* t, float* x, float* y);
+void bezier_rational_bicubic_rectangle(const float control_point[48], size_t count, const float* u, const float* v, float* x, float* y);
+void bezier_rational_cubic_triangle(const float control_point[30], size_t count, const float* u, const float* v, const float* w, float* x, float* y);
+
+// Root finders for bezier_cubic_roots.
+// Bisection halves the interval until it is narrower than 1e-4, as 'intersections' does.
+// Clipping intersects the convex hull of the control polygon with zero to shrink the interval (Bezier clipping) until the polygon
+// changes sign once, then finds that root with a safeguarded Newton iteration in double precision. On benchmark/cpu.c's cubics this
+// is about 25% faster per root than bisection on random ones but about 1.8 times slower on near tangent ones, where the clipping
+// converges linearly around the pair of roots, with roots accurate to about 1e-8 rather than 1e-5.
+enum bezier_solver
+{
+	BEZIER_BISECTION,
+	BEZIER_CLIPPING
+};
+
+// Roots in [0,1] of the cubic with Bernstein coefficients a (e.g. signed distances of the control points from a line).
+// At most 3 roots are written in ascending order, returns their count.
+// If iterations isn't NULL the number of subdivision, clipping and Newton steps taken is added to it.
+int bezier_cubic_roots(const float a[4], enum bezier_solver solver, float root[3], int* iterations);
+
+// Intersects cubic curve i (8 floats laid out as for bezier_cubic_curve) with the line through (x0,y0) and (x1,y1) at line + i * line_stride,
+// a line_stride of 0 intersects every curve with the same line.
+// The parameters of the intersections are written compactly to root (which must hold 3 * count floats) with curve i's count in root_count[i],
+// returns the total number of roots.
+size_t bezier_intersect_lines(size_t count, const float* curve, const float* line, size_t line_stride, enum bezier_solver solver, float* root, int* root_count);
+
+// Intersection between curves first < second of a set, at parameter s along first and t along second.
+struct bezier_intersection
+{
+	size_t first, second;
+	float s, t;
+};
+
+// Intersections of cubic curves a and b by recursive subdivision, rejecting pairs of pieces whose bounding boxes
+// or fat lines (the strip around a piece's chord containing it) don't overlap.
+// Writes up to 9 (the most two distinct cubics can have) parameter pairs to s and t, returns their count.
+// Overlapping curves report up to 9 points of the overlap.
+int bezier_curve_intersections(const float a[8], const float b[8], float s[9], float t[9]);
+
+// All intersections between count cubic curves (8 floats each), self intersections aren't included.
+// The broad phase sorts the curves' bounding boxes along x and sweeps them so only overlapping pairs are subdivided.
+// Up to capacity intersections are written to intersection, returns the total found.
+size_t bezier_intersect_curves(size_t count, const float* curve, struct bezier_intersection* intersection, size_t capacity);
+
+// Spatial index of points (e.g. control points in pixels) for picking, a uniform grid of square cells over [low,high]
+// whose cells list their points. Moving a point only relinks it, and queries only visit the cells they overlap,
+// so for points spread over the bounds both take constant time however many points there are.
+struct bezier_picker
+{
+	float low[2];
+	float cell_size;
+	int columns, rows;
+
+	size_t count;
+	float* point;
+	int* head;
+	int* next;
+	int* previous;
+	int* cell;
+};
+
+// Indexes count points (interleaved x,y pairs, copied), returns non-zero if out of memory.
+// Points outside [low,high] are still found, but are slower to query if many are.
+int bezier_picker_init(struct bezier_picker* picker, size_t count, const float* point, const float low[2], const float high[2], float cell_size);
+void bezier_picker_free(struct bezier_picker* picker);
+void bezier_picker_move(struct bezier_picker* picker, size_t point, float x, float y);
+
+// Index of the point nearest (x,y) within radius, or -1 if there isn't one.
+long bezier_picker_nearest(const struct bezier_picker* picker, float x, float y, float radius);
+
+// Points in the box [low,high], up to capacity indices are written to selection, returns the total.
+size_t bezier_picker_box(const struct bezier_picker* picker, const float low[2], const float high[2], size_t* selection, size_t capacity);
+
+// Patches processed in batches by the hit tester and the tessellator.
+enum bezier_patch
+{
+	// 8 floats, as for bezier_cubic_curve. Composite curves can be converted with bezier_composite_curve.
+	BEZIER_PATCH_CUBIC_CURVE,
+	// 9 floats, as for bezier_rational_quadratic, when hit testing pieces are split until their weights are positive, so the curve mustn't pass through infinity.
+	BEZIER_PATCH_RATIONAL_QUADRATIC,
+	// 32 floats, as for bezier_bicubic_rectangle. Points the surface covers are at distance zero when hit testing.
+	BEZIER_PATCH_BICUBIC_RECTANGLE,
+	// 20 floats, as for bezier_cubic_triangle. Only tessellated.
+	BEZIER_PATCH_CUBIC_TRIANGLE,
+	// 12 floats, as for bezier_rational_cubic_curve, when hit testing pieces are split until their weights are positive, so the curve mustn't pass through infinity.
+	BEZIER_PATCH_RATIONAL_CUBIC_CURVE,
+	// 48 floats, as for bezier_rational_bicubic_rectangle. Only tessellated.
+	BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE,
+	// 30 floats, as for bezier_rational_cubic_triangle. Only tessellated.
+	BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE
+};
+
+int bezier_patch_floats(enum bezier_patch type);
+
+// Hit testing: the closest point of a set of patches to a query point, e.g. the curve under the cursor and the parameter there.
+
+// Patches aren't copied, but each one's control point bounding box is cached and must be refreshed with bezier_hit_update after editing it.
+struct bezier_hit_tester
+{
+	enum bezier_patch type;
+	size_t count;
+	const float* patch;
+	float* box;
+};
+
+// Closest point (x,y) on 'patch' at parameter u (and v for surfaces, matching gl_TessCoord), 'distance' from the query.
+struct bezier_hit
+{
+	long patch;
+	float u, v;
+	float x, y;
+	float distance;
+};
+
+// Returns non-zero if out of memory or the type can't be hit tested.
+int bezier_hit_init(struct bezier_hit_tester* tester, enum bezier_patch type, size_t count, const float* patch);
+void bezier_hit_update(struct bezier_hit_tester* tester, size_t patch);
+void bezier_hit_free(struct bezier_hit_tester* tester);
+
+// Finds the closest point within radius of (x,y), returns 0 (and a patch of -1) if there isn't one.
+// Patches whose cached box is further away than the closest point so far are skipped, the rest are subdivided,
+// rejecting pieces whose control point box is further away and visiting the nearer half first, until pieces are 1/1000 of the radius.
+int bezier_hit_test(const struct bezier_hit_tester* tester, float x, float y, float radius, struct bezier_hit* hit);
+
+// Cubic curves (8 floats each) of a 'composite curve' with count knots, each a point and its handle (4 floats) as the demonstration uploads them.
+// Writes count - 1 curves, or count if closed.
+void bezier_composite_curve(size_t count, const float* knot, int closed, float* curve);
+
+// Paths: any number of open or closed composite curves stored contiguously, e.g. millions of segments loaded from disk.
+// Knots are (P0, P1) pairs, a point and its outgoing handle, as 'composite curve' uploads them. A segment's incoming handle is the next knot's handle
+// reflected through its point and scaled by that knot's ratio, so a ratio of 1 is velocity (C1) continuous and any other positive ratio only keeps
+// the tangent's direction (G1).
+// Segments are numbered through the subpaths in order, a closed subpath's last segment returns to its first knot.
+struct bezier_path
+{
+	size_t knot_count, knot_capacity;
+	float* knot;
+	float* ratio;
+
+	// First knot and first segment of each subpath, with one more entry for the end of the last.
+	size_t subpath_count, subpath_capacity;
+	size_t* subpath_knot;
+	size_t* subpath_segment;
+	unsigned char* closed;
+};
+
+// Returns non-zero if out of memory.
+int bezier_path_init(struct bezier_path* path);
+void bezier_path_free(struct bezier_path* path);
+
+// Starts a subpath, knots added after it belong to it.
+int bezier_path_begin(struct bezier_path* path, int closed);
+int bezier_path_add(struct bezier_path* path, const float knot[4], float ratio);
+
+// Appends the subpaths of a text file: 'open' or 'closed' starts a subpath and each following line is a knot "x y handle_x handle_y [ratio]".
+// Returns non-zero if the file can't be read or is malformed.
+int bezier_path_load(struct bezier_path* path, const char* file);
+
+size_t bezier_path_segments(const struct bezier_path* path);
+
+// Writes the knot index pairs of segments [first, first + count) to index (2 per segment), as drawn with GL_PATCHES of 2 vertices.
+// Returns one more than the largest index written, the knots that must be uploaded before the segments are drawn.
+size_t bezier_path_indices(const struct bezier_path* path, size_t first, size_t count, unsigned int* index);
+
+// Cubic curves (8 floats each) of segments [first, first + count), e.g. for hit testing.
+void bezier_path_curves(const struct bezier_path* path, size_t first, size_t count, float* curve);
+
+// Conic sections through P_0, P_1 and P_2 tangent at P_0 and P_2 to the lines towards T_0 and T_2, as 'conic section' builds them.
+// Specifications are 10 floats each (P_0, P_1, P_2, T_0, T_2), a batch at a time in SIMD lanes. Writes BEZIER_PATCH_RATIONAL_QUADRATIC patches
+// (P_0, w B, P_2) with B where the tangents meet, found in homogeneous coordinates so parallel tangents give w = 0 and the half ellipse between them.
+// Specifications without a finite arc from P_0 through P_1 to P_2 (P_1 on a tangent or past them, or the tangents on one line) are written as the chord,
+// flagged in degenerate if it isn't NULL. Returns how many there were.
+size_t bezier_conic_sections(size_t count, const float* specification, float* patch, int* degenerate);
+
+// Arc length tables for sampling curves at uniform speed, BEZIER_ARC_LENGTH_FLOATS per curve: the curve's length, its largest curvature
+// and the parameters at which BEZIER_ARC_LENGTH_SAMPLES + 1 equal fractions of the length are reached, to interpolate linearly.
+// Both are measured on the polyline through BEZIER_ARC_LENGTH_STEPS + 1 uniform parameters, evaluated a curve at a time in SIMD lanes.
+// Stored in a shader storage buffer they let 'cubic curve' reparameterize by arc length, see its control shader.
+#define BEZIER_ARC_LENGTH_SAMPLES 16
+#define BEZIER_ARC_LENGTH_FLOATS (BEZIER_ARC_LENGTH_SAMPLES + 3)
+#define BEZIER_ARC_LENGTH_STEPS 128
+
+// Cubic curves or rational cubic curves only, returns non-zero for other patches.
+int bezier_arc_length_tables(enum bezier_patch type, size_t count, const float* curve, float* table);
+
+// Bump allocator: allocations are 32 byte aligned and only released together by a reset.
+struct bezier_arena
+{
+	char* base;
+	size_t capacity;
+	size_t used;
+};
+
+int bezier_arena_init(struct bezier_arena* arena, size_t capacity);
+// NULL if the arena is full.
+void* bezier_arena_alloc(struct bezier_arena* arena, size_t size);
+void bezier_arena_reset(struct bezier_arena* arena);
+void bezier_arena_free(struct bezier_arena* arena);
+
+// gl_MaxTessGenLevel's minimum, levels are clamped to it.
+#define BEZIER_MAX_LEVEL 64
+
+// The levels a control shader writes to gl_TessLevelOuter and gl_TessLevelInner. Curves use outer[0] (lines) and outer[1] (segments),
+// cubic triangles outer[0..2] and inner[0], bicubic rectangles all six.
+struct bezier_levels
+{
+	float outer[4];
+	float inner[2];
+};
+
+// x, y then gl_TessCoord (u, v, w).
+#define BEZIER_VERTEX_FLOATS 5
+
+// Indexed lines (curves) or counter-clockwise triangles (surfaces), patch i's vertices and indices start at vertex_offset[i] and index_offset[i].
+// Indices are into the whole batch's vertices so it can be drawn at once.
+struct bezier_mesh
+{
+	size_t patches;
+	int primitive_vertices;
+
+	size_t vertex_count;
+	float* vertex;
+
+	size_t index_count;
+	unsigned int* index;
+
+	size_t* vertex_offset;
+	size_t* index_offset;
+};
+
+// Tessellates count patches as the GL does with the demonstrations' evaluation shaders: 'cubic curve' and 'conic section' as isolines,
+// 'bicubic rectangle' as quads and 'cubic triangle' as triangles (and their rational forms likewise), with equal spacing and counter-clockwise triangles.
+// The vertices are where the GL puts them, the triangulation between rings is left to the implementation so can differ while covering the same area.
+// Patches are split between up to 'threads' threads, the mesh is allocated from the arena. Returns non-zero if the arena is too small.
+int bezier_tessellate(enum bezier_patch type, size_t count, const float* patch, const struct bezier_levels* levels, int threads, struct bezier_arena* arena, struct bezier_mesh* mesh);
+
+// Solve stage: derived geometry (e.g. the intersections or conics of thousands of constructs) computed on worker threads while the caller draws.
+// Batches pass to the stage's leader thread and back through lock-free single producer single consumer rings, so the caller never waits on them.
+// Each thread starts on an equal share of a batch's items and one that runs out steals the back half of another's share,
+// so items that differ in cost stay balanced. The threads persist between batches.
+struct bezier_batch
+{
+	// Called on ranges of [0,count) of at most grain items, from any of the stage's threads. Count must be below 2^32.
+	void (*function)(struct bezier_batch* batch, size_t begin, size_t end);
+	size_t count;
+	size_t grain;
+
+	// Called on the leader with the context once the batch can be taken back, e.g. to wake the caller's event loop, may be NULL.
+	void (*finished)(void* context);
+	void* context;
+};
+
+struct bezier_stage;
+
+// Batches run on 'threads' threads, the leader included, with up to capacity in flight. NULL if out of memory or the leader can't be started.
+struct bezier_stage* bezier_stage_create(int threads, size_t capacity);
+// Finishes the batches in flight first.
+void bezier_stage_destroy(struct bezier_stage* stage);
+
+// Batches must be submitted and taken back by one thread, and stay valid until taken back.
+// Returns non-zero if capacity batches are already in flight or the batch is too large.
+int bezier_stage_submit(struct bezier_stage* stage, struct bezier_batch* batch);
+// The oldest finished batch, or NULL if none has finished. Batches finish in the order they were submitted.
+struct bezier_batch* bezier_stage_take(struct bezier_stage* stage);
+
+#endif
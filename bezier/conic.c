@@ -0,0 +1,113 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+#include "simd.h"
+
+#include <float.h>
+#include <math.h>
+
+// Squared sine between the tangent lines below which they're taken to be one line, about 100 float roundings.
+#define COINCIDENT 1e-10f
+
+// Twice the signed area of the triangle a, (X,Y,W), c with the middle point homogeneous, W times the area with (X/W,Y/W).
+static vfloat area(vfloat ax, vfloat ay, vfloat X, vfloat Y, vfloat W, vfloat cx, vfloat cy)
+{
+	return vfma(X, vsub(cy, ay), vfma(Y, vsub(ax, cx), vmul(W, vsub(vmul(ay, cx), vmul(ax, cy)))));
+}
+
+size_t bezier_conic_sections(size_t count, const float* specification, float* patch, int* degenerate)
+{
+	size_t total = 0;
+
+	for (size_t i = 0; i < count; i += LANES)
+	{
+		const size_t lanes = count - i < LANES ? count - i : LANES;
+
+		// P_0, P_1, P_2, T_0, T_2, one specification per lane.
+		float in[10][LANES] = { 0 };
+
+		for (size_t k = 0; k < lanes; k++)
+			for (int j = 0; j < 10; j++)
+				in[j][k] = specification[10 * (i + k) + j];
+
+		const vfloat x0 = vload(in[0]), y0 = vload(in[1]);
+		const vfloat x1 = vload(in[2]), y1 = vload(in[3]);
+		const vfloat x2 = vload(in[4]), y2 = vload(in[5]);
+
+		// The tangent lines as a x + b y = c, the first through P_0 and T_0 and the second through P_2 and T_2.
+		const vfloat a0 = vsub(vload(in[7]), y0), b0 = vsub(x0, vload(in[6]));
+		const vfloat c0 = vsub(vmul(vload(in[7]), x0), vmul(vload(in[6]), y0));
+
+		const vfloat a2 = vsub(vload(in[9]), y2), b2 = vsub(x2, vload(in[8]));
+		const vfloat c2 = vsub(vmul(vload(in[9]), x2), vmul(vload(in[8]), y2));
+
+		// Their intersection B = (X,Y) / W is homogeneous, so parallel tangents give W = 0 and B their direction rather than a division by zero.
+		const vfloat X = vsub(vmul(c0, b2), vmul(b0, c2));
+		const vfloat Y = vsub(vmul(a0, c2), vmul(c0, a2));
+		const vfloat W = vsub(vmul(a0, b2), vmul(b0, a2));
+
+		// (X,Y,W) is the cross product of the lines' (a,b,-c), its length relative to theirs the sine between them.
+		// Tangents on one line leave only rounding, which would otherwise be taken for an intersection.
+		const vfloat meet = vfma(X, X, vfma(Y, Y, vmul(W, W)));
+		const vfloat lines = vmul(vfma(a0, a0, vfma(b0, b0, vmul(c0, c0))), vfma(a2, a2, vfma(b2, b2, vmul(c2, c2))));
+
+		// The weight is 1/2 area(P_0,P_1,P_2) / sqrt(area(P_1,B,P_2) area(P_0,B,P_1)), with B homogeneous the areas are W times as large
+		// so scaling (X,Y,W) by the same expression gives w B and w with W cancelling.
+		const vfloat opposite = area(x1, y1, X, Y, W, x2, y2);
+		const vfloat product = vmul(opposite, area(x0, y0, X, Y, W, x1, y1));
+		const vfloat scale = vdiv(vmul(vset(0.5f), area(x0, y0, x1, y1, vset(1.0f), x2, y2)), vsqrt(vmax(product, vset(FLT_MIN))));
+
+		float p[LANES], s[LANES], side[LANES], h[3][LANES], coincident[LANES];
+
+		vstore(p, product);
+		vstore(s, scale);
+		vstore(side, opposite);
+		vstore(h[0], X);
+		vstore(h[1], Y);
+		vstore(h[2], W);
+		vstore(coincident, vsub(meet, vmul(vset(COINCIDENT), lines)));
+
+		for (size_t k = 0; k < lanes; k++)
+		{
+			float* out = patch + 9 * (i + k);
+
+			// P_1 is between P_0 and P_2 on the arc when its barycentric coordinates (P_0,B,P_2) are positive at either end,
+			// otherwise it's on the rest of the conic which the opposite weight draws. The sign of area(P_1,B,P_2) is both.
+			const float sign = side[k] < 0 ? -1.0f : 1.0f;
+			const float w = sign * s[k] * h[2][k];
+
+			// No finite arc from P_0 through P_1 to P_2: P_1 on a tangent or past them, or the tangents on one line.
+			// Weights in (-1,0) are the rest of an ellipse, from -1 down the arc passes through infinity.
+			const int failed = !(p[k] > 0) || !(coincident[k] > 0) || !(w > -1.0f) || !isfinite(s[k] * h[0][k]) || !isfinite(s[k] * h[1][k]) || !isfinite(w);
+
+			out[0] = in[0][k];
+			out[1] = in[1][k];
+			out[2] = 1.0f;
+			out[6] = in[4][k];
+			out[7] = in[5][k];
+			out[8] = 1.0f;
+
+			if (failed)
+			{
+				out[3] = 0.5f * (in[0][k] + in[4][k]);
+				out[4] = 0.5f * (in[1][k] + in[5][k]);
+				out[5] = 1.0f;
+			}
+			else
+			{
+				out[3] = sign * s[k] * h[0][k];
+				out[4] = sign * s[k] * h[1][k];
+				out[5] = w;
+			}
+
+			if (degenerate)
+				degenerate[i + k] = failed;
+
+			total += failed;
+		}
+	}
+
+	return total;
+}
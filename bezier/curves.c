@@ -0,0 +1,293 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Pieces smaller than this (in the curves' coordinates) are treated as a point of intersection.
+#define TOLERANCE 1e-6
+#define CHORD_SIZE 1e-3
+// Leaves closer than this in both parameters are the same intersection found either side of a split.
+#define MERGE 1e-4
+#define MAX_INTERSECTIONS 9
+#define MAX_STEPS 10000
+#define MAX_STACK 64
+
+struct piece
+{
+	double low, high;
+	double p[8];
+};
+
+static void bounds(const double p[8], double box[4])
+{
+	box[0] = box[2] = p[0];
+	box[1] = box[3] = p[1];
+
+	for (int i = 1; i < 4; i++)
+	{
+		box[0] = fmin(box[0], p[2 * i]);
+		box[1] = fmin(box[1], p[2 * i + 1]);
+		box[2] = fmax(box[2], p[2 * i]);
+		box[3] = fmax(box[3], p[2 * i + 1]);
+	}
+}
+
+// The curve a lies in the strip [low,high] about its chord, if all of b's control points are outside on one side they can't meet.
+static int fat_line_reject(const double a[8], const double b[8])
+{
+	const double dx = a[6] - a[0];
+	const double dy = a[7] - a[1];
+	const double length = sqrt(dx * dx + dy * dy);
+
+	if (length == 0)
+		return 0;
+
+	const double nx = -dy / length;
+	const double ny = dx / length;
+	const double c = -(nx * a[0] + ny * a[1]);
+
+	const double d1 = nx * a[2] + ny * a[3] + c;
+	const double d2 = nx * a[4] + ny * a[5] + c;
+
+	// Bounds of a cubic from the distances of its inner control points, see Sederberg and Nishita.
+	const double factor = d1 * d2 > 0 ? 3.0 / 4.0 : 4.0 / 9.0;
+	const double low = factor * fmin(0.0, fmin(d1, d2)) - TOLERANCE;
+	const double high = factor * fmax(0.0, fmax(d1, d2)) + TOLERANCE;
+
+	int below = 0, above = 0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		const double d = nx * b[2 * i] + ny * b[2 * i + 1] + c;
+
+		below += d < low;
+		above += d > high;
+	}
+
+	return below == 4 || above == 4;
+}
+
+// Largest distance of the inner control points from the chord, which bounds the curve's.
+static double flatness(const double p[8])
+{
+	const double dx = p[6] - p[0];
+	const double dy = p[7] - p[1];
+	const double length = sqrt(dx * dx + dy * dy);
+
+	if (length == 0)
+		return fmax(fmax(fabs(p[2] - p[0]), fabs(p[3] - p[1])), fmax(fabs(p[4] - p[0]), fabs(p[5] - p[1])));
+
+	const double d1 = fabs(dx * (p[3] - p[1]) - dy * (p[2] - p[0])) / length;
+	const double d2 = fabs(dx * (p[5] - p[1]) - dy * (p[4] - p[0])) / length;
+
+	return fmax(d1, d2);
+}
+
+// Intersection of the chords at u along a's and v along b's, parallel chords (e.g. overlapping curves) meet at their midpoints.
+static int chord_intersection(const double a[8], const double b[8], double* u, double* v)
+{
+	const double ax = a[6] - a[0], ay = a[7] - a[1];
+	const double bx = b[6] - b[0], by = b[7] - b[1];
+	const double cx = b[0] - a[0], cy = b[1] - a[1];
+
+	const double d = ax * by - ay * bx;
+
+	if (d == 0)
+		return 1;
+
+	*u = (cx * by - cy * bx) / d;
+	*v = (cx * ay - cy * ax) / d;
+
+	// Allow for the tolerance the chords are within of the curves.
+	const double slack_a = TOLERANCE / fmax(sqrt(ax * ax + ay * ay), TOLERANCE);
+	const double slack_b = TOLERANCE / fmax(sqrt(bx * bx + by * by), TOLERANCE);
+
+	if (*u < -slack_a || *u > 1 + slack_a || *v < -slack_b || *v > 1 + slack_b)
+		return 0;
+
+	*u = fmin(fmax(*u, 0.0), 1.0);
+	*v = fmin(fmax(*v, 0.0), 1.0);
+
+	return 1;
+}
+
+static void split(const struct piece* piece, struct piece* low, struct piece* high)
+{
+	const double mid = 0.5 * (piece->low + piece->high);
+
+	low->low = piece->low;
+	low->high = mid;
+	high->low = mid;
+	high->high = piece->high;
+
+	for (int k = 0; k < 2; k++)
+	{
+		const double* p = piece->p + k;
+
+		const double p01 = 0.5 * (p[0] + p[2]);
+		const double p12 = 0.5 * (p[2] + p[4]);
+		const double p23 = 0.5 * (p[4] + p[6]);
+		const double p012 = 0.5 * (p01 + p12);
+		const double p123 = 0.5 * (p12 + p23);
+		const double p0123 = 0.5 * (p012 + p123);
+
+		low->p[k] = p[0];
+		low->p[2 + k] = p01;
+		low->p[4 + k] = p012;
+		low->p[6 + k] = p0123;
+
+		high->p[k] = p0123;
+		high->p[2 + k] = p123;
+		high->p[4 + k] = p23;
+		high->p[6 + k] = p[6];
+	}
+}
+
+int bezier_curve_intersections(const float a[8], const float b[8], float s[9], float t[9])
+{
+	struct stack_frame {
+		struct piece a, b;
+	} stack[MAX_STACK];
+
+	int height = 1;
+	int count = 0;
+
+	stack[0].a.low = stack[0].b.low = 0.0;
+	stack[0].a.high = stack[0].b.high = 1.0;
+
+	for (int i = 0; i < 8; i++)
+	{
+		stack[0].a.p[i] = a[i];
+		stack[0].b.p[i] = b[i];
+	}
+
+	for (int step = 0; height && step < MAX_STEPS && count < MAX_INTERSECTIONS; step++)
+	{
+		const struct stack_frame frame = stack[--height];
+
+		double box_a[4], box_b[4];
+		bounds(frame.a.p, box_a);
+		bounds(frame.b.p, box_b);
+
+		if (box_a[0] > box_b[2] || box_b[0] > box_a[2] || box_a[1] > box_b[3] || box_b[1] > box_a[3])
+			continue;
+
+		if (fat_line_reject(frame.a.p, frame.b.p) || fat_line_reject(frame.b.p, frame.a.p))
+			continue;
+
+		const double size_a = fmax(box_a[2] - box_a[0], box_a[3] - box_a[1]);
+		const double size_b = fmax(box_b[2] - box_b[0], box_b[3] - box_b[1]);
+
+		// Once both pieces are small and within tolerance of their chords the chords' intersection is the curves'.
+		// The size limit keeps the error from treating the chord's parameter as the curve's small.
+		double u_chord = 0.5, v_chord = 0.5;
+		const int chords = fmax(size_a, size_b) < CHORD_SIZE && flatness(frame.a.p) < TOLERANCE && flatness(frame.b.p) < TOLERANCE;
+
+		if (chords && !chord_intersection(frame.a.p, frame.b.p, &u_chord, &v_chord))
+			continue;
+
+		if (chords || (size_a < TOLERANCE && size_b < TOLERANCE))
+		{
+			const float u = (float)(frame.a.low + u_chord * (frame.a.high - frame.a.low));
+			const float v = (float)(frame.b.low + v_chord * (frame.b.high - frame.b.low));
+
+			int duplicate = 0;
+
+			for (int j = 0; j < count && !duplicate; j++)
+				duplicate = fabsf(s[j] - u) < MERGE && fabsf(t[j] - v) < MERGE;
+
+			if (!duplicate)
+			{
+				s[count] = u;
+				t[count] = v;
+				count++;
+			}
+
+			continue;
+		}
+
+		if (height + 2 > MAX_STACK)
+			continue;
+
+		// Split the larger piece, pushing the high half first so the parameters are visited in order.
+		if (size_a >= size_b)
+		{
+			split(&frame.a, &stack[height + 1].a, &stack[height].a);
+			stack[height].b = stack[height + 1].b = frame.b;
+		}
+		else
+		{
+			split(&frame.b, &stack[height + 1].b, &stack[height].b);
+			stack[height].a = stack[height + 1].a = frame.a;
+		}
+
+		height += 2;
+	}
+
+	return count;
+}
+
+struct box
+{
+	float low[2], high[2];
+	size_t index;
+};
+
+static int compare_box(const void* a, const void* b)
+{
+	const float x = ((const struct box*)a)->low[0];
+	const float y = ((const struct box*)b)->low[0];
+
+	return (x > y) - (x < y);
+}
+
+size_t bezier_intersect_curves(size_t count, const float* curve, struct bezier_intersection* intersection, size_t capacity)
+{
+	struct box* box = malloc(count * sizeof(struct box));
+
+	if (!box)
+		return 0;
+
+	// The control polygon's bounding box contains the curve.
+	for (size_t i = 0; i < count; i++)
+	{
+		const float* p = curve + 8 * i;
+
+		box[i].index = i;
+
+		for (int k = 0; k < 2; k++)
+		{
+			box[i].low[k] = fminf(fminf(p[k], p[2 + k]), fminf(p[4 + k], p[6 + k]));
+			box[i].high[k] = fmaxf(fmaxf(p[k], p[2 + k]), fmaxf(p[4 + k], p[6 + k]));
+		}
+	}
+
+	qsort(box, count, sizeof(struct box), compare_box);
+
+	size_t total = 0;
+
+	for (size_t i = 0; i < count; i++)
+		for (size_t j = i + 1; j < count && box[j].low[0] <= box[i].high[0]; j++)
+		{
+			if (box[j].low[1] > box[i].high[1] || box[i].low[1] > box[j].high[1])
+				continue;
+
+			const size_t first = box[i].index < box[j].index ? box[i].index : box[j].index;
+			const size_t second = box[i].index < box[j].index ? box[j].index : box[i].index;
+
+			float s[MAX_INTERSECTIONS], t[MAX_INTERSECTIONS];
+			const int found = bezier_curve_intersections(curve + 8 * first, curve + 8 * second, s, t);
+
+			for (int k = 0; k < found; k++, total++)
+				if (total < capacity)
+					intersection[total] = (struct bezier_intersection){ .first = first, .second = second, .s = s[k], .t = t[k] };
+		}
+
+	free(box);
+
+	return total;
+}
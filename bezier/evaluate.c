@@ -0,0 +1,265 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+#include "simd.h"
+
+#include <string.h>
+
+// The shaders use de Casteljau's algorithm since each invocation only evaluates one point,
+// here the Bernstein basis is shared between the coordinates so each output is a short sum of fused multiply-adds.
+// For parameters in [0,1] both forms are numerically stable.
+
+const char* bezier_simd_name()
+{
+	return SIMD_NAME;
+}
+
+int bezier_simd_width()
+{
+	return LANES;
+}
+
+static inline void cubic_basis(vfloat t, vfloat b[4])
+{
+	const vfloat s = vsub(vset(1.0f), t);
+	const vfloat s2 = vmul(s, s);
+	const vfloat t2 = vmul(t, t);
+
+	b[0] = vmul(s2, s);
+	b[1] = vmul(vset(3.0f), vmul(s2, t));
+	b[2] = vmul(vset(3.0f), vmul(s, t2));
+	b[3] = vmul(t2, t);
+}
+
+static inline vfloat dot4(const vfloat b[4], const vfloat p[], int stride)
+{
+	return vfma(b[3], p[3 * stride], vfma(b[2], p[2 * stride], vfma(b[1], p[stride], vmul(b[0], p[0]))));
+}
+
+// Control points have 'size' coordinates: 2 for polynomial patches, or 3 for rational ones whose sums are projected.
+// The kernels are inlined into their callers so the size is a constant and the polynomial ones don't sum the weights.
+static inline void project(int size, vfloat sx, vfloat sy, vfloat sw, float* x, float* y)
+{
+	if (size == 3)
+	{
+		sx = vdiv(sx, sw);
+		sy = vdiv(sy, sw);
+	}
+
+	vstore(x, sx);
+	vstore(y, sy);
+}
+
+static inline void cubic_curve(const vfloat* p, int size, const float* t, float* x, float* y)
+{
+	vfloat b[4];
+	cubic_basis(vload(t), b);
+
+	project(size, dot4(b, p, size), dot4(b, p + 1, size), size == 3 ? dot4(b, p + 2, size) : b[0], x, y);
+}
+
+static inline void bicubic_rectangle(const vfloat* p, int size, const float* u, const float* v, float* x, float* y)
+{
+	vfloat bu[4], bv[4], row[12];
+	cubic_basis(vload(u), bu);
+	cubic_basis(vload(v), bv);
+
+	// Matches the evaluation shader: rows (j) are combined by u and columns (i) by v.
+	for (int i = 0; i < 4; i++)
+		for (int k = 0; k < size; k++)
+			row[size * i + k] = dot4(bu, p + size * i + k, 4 * size);
+
+	project(size, dot4(bv, row, size), dot4(bv, row + 1, size), size == 3 ? dot4(bv, row + 2, size) : bv[0], x, y);
+}
+
+static inline void cubic_triangle(const vfloat* p, int size, const float* u, const float* v, const float* w, float* x, float* y)
+{
+	const vfloat a = vload(u);
+	const vfloat b = vload(v);
+	const vfloat c = vload(w);
+
+	const vfloat a2 = vmul(a, a);
+	const vfloat b2 = vmul(b, b);
+	const vfloat c2 = vmul(c, c);
+	const vfloat three = vset(3.0f);
+
+	// Point k of row r is weighted by 3!/((3-r)!(r-k)!k!) u^(3-r) v^(r-k) w^k.
+	const vfloat basis[10] = {
+		vmul(a2, a),
+		vmul(three, vmul(a2, b)), vmul(three, vmul(a2, c)),
+		vmul(three, vmul(a, b2)), vmul(vset(6.0f), vmul(a, vmul(b, c))), vmul(three, vmul(a, c2)),
+		vmul(b2, b), vmul(three, vmul(b2, c)), vmul(three, vmul(b, c2)), vmul(c2, c),
+	};
+
+	vfloat sum[3];
+
+	for (int k = 0; k < size; k++)
+		sum[k] = vmul(basis[0], p[k]);
+
+	for (int i = 1; i < 10; i++)
+		for (int k = 0; k < size; k++)
+			sum[k] = vfma(basis[i], p[size * i + k], sum[k]);
+
+	project(size, sum[0], sum[1], size == 3 ? sum[2] : basis[0], x, y);
+}
+
+static void rational_quadratic(const vfloat p[9], const float* t, float* x, float* y)
+{
+	const vfloat u = vload(t);
+	const vfloat s = vsub(vset(1.0f), u);
+
+	const vfloat b0 = vmul(s, s);
+	const vfloat b1 = vmul(vset(2.0f), vmul(s, u));
+	const vfloat b2 = vmul(u, u);
+
+	const vfloat w = vfma(b2, p[8], vfma(b1, p[5], vmul(b0, p[2])));
+
+	vstore(x, vdiv(vfma(b2, p[6], vfma(b1, p[3], vmul(b0, p[0]))), w));
+	vstore(y, vdiv(vfma(b2, p[7], vfma(b1, p[4], vmul(b0, p[1]))), w));
+}
+
+static void broadcast(const float* control_point, int count, vfloat* p)
+{
+	for (int i = 0; i < count; i++)
+		p[i] = vset(control_point[i]);
+}
+
+// Copies the last partial batch into full width buffers, padding parameters with zero.
+#define TAIL(i, count, ...) \
+	const size_t tail = (count) - (i); \
+	float buffer[5][LANES] = { 0 }; \
+	const float* in[3] = { __VA_ARGS__ }; \
+	for (int k = 0; k < 3 && in[k]; k++) \
+		memcpy(buffer[k], in[k] + (i), tail * sizeof(float));
+
+#define TAIL_STORE(i, x, y) \
+	memcpy((x) + (i), buffer[3], tail * sizeof(float)); \
+	memcpy((y) + (i), buffer[4], tail * sizeof(float));
+
+void bezier_cubic_curve(const float control_point[8], size_t count, const float* t, float* x, float* y)
+{
+	vfloat p[8];
+	broadcast(control_point, 8, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		cubic_curve(p, 2, t + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, t, NULL, NULL);
+		cubic_curve(p, 2, buffer[0], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
+
+void bezier_bicubic_rectangle(const float control_point[32], size_t count, const float* u, const float* v, float* x, float* y)
+{
+	vfloat p[32];
+	broadcast(control_point, 32, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		bicubic_rectangle(p, 2, u + i, v + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, u, v, NULL);
+		bicubic_rectangle(p, 2, buffer[0], buffer[1], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
+
+void bezier_cubic_triangle(const float control_point[20], size_t count, const float* u, const float* v, const float* w, float* x, float* y)
+{
+	vfloat p[20];
+	broadcast(control_point, 20, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		cubic_triangle(p, 2, u + i, v + i, w + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, u, v, w);
+		cubic_triangle(p, 2, buffer[0], buffer[1], buffer[2], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
+
+void bezier_rational_quadratic(const float control_point[9], size_t count, const float* t, float* x, float* y)
+{
+	vfloat p[9];
+	broadcast(control_point, 9, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		rational_quadratic(p, t + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, t, NULL, NULL);
+		rational_quadratic(p, buffer[0], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
+
+void bezier_rational_cubic_curve(const float control_point[12], size_t count, const float* t, float* x, float* y)
+{
+	vfloat p[12];
+	broadcast(control_point, 12, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		cubic_curve(p, 3, t + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, t, NULL, NULL);
+		cubic_curve(p, 3, buffer[0], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
+
+void bezier_rational_bicubic_rectangle(const float control_point[48], size_t count, const float* u, const float* v, float* x, float* y)
+{
+	vfloat p[48];
+	broadcast(control_point, 48, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		bicubic_rectangle(p, 3, u + i, v + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, u, v, NULL);
+		bicubic_rectangle(p, 3, buffer[0], buffer[1], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
+
+void bezier_rational_cubic_triangle(const float control_point[30], size_t count, const float* u, const float* v, const float* w, float* x, float* y)
+{
+	vfloat p[30];
+	broadcast(control_point, 30, p);
+
+	size_t i = 0;
+
+	for (; i + LANES <= count; i += LANES)
+		cubic_triangle(p, 3, u + i, v + i, w + i, x + i, y + i);
+
+	if (i < count)
+	{
+		TAIL(i, count, u, v, w);
+		cubic_triangle(p, 3, buffer[0], buffer[1], buffer[2], buffer[3], buffer[4]);
+		TAIL_STORE(i, x, y);
+	}
+}
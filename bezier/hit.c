@@ -0,0 +1,427 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Pieces are subdivided until they are this fraction of the query's radius, their end points (or corners) then approximate the closest point.
+#define TOLERANCE 1e-3
+#define MAX_STEPS 10000
+#define MAX_STACK 64
+
+// Pieces of a curve with a weight that isn't positive are halved up to this many times for its cached box.
+#define MAX_SPLITS 8
+
+struct curve_piece
+{
+	double low, high;
+	// Homogeneous (w*x, w*y, w) control points, w = 1 for polynomial curves.
+	double p[4][3];
+};
+
+struct surface_piece
+{
+	double u[2], v[2];
+	double p[16][2];
+};
+
+// Squared distance from (x,y) to the box, zero inside.
+// Comparisons rather than fmax, which isn't inlined without -ffast-math and dominates scanning many patches.
+static double box_distance(const double box[4], double x, double y)
+{
+	const double dx = x < box[0] ? box[0] - x : x > box[2] ? x - box[2] : 0.0;
+	const double dy = y < box[1] ? box[1] - y : y > box[3] ? y - box[3] : 0.0;
+
+	return dx * dx + dy * dy;
+}
+
+static void include(double box[4], double x, double y)
+{
+	box[0] = fmin(box[0], x);
+	box[1] = fmin(box[1], y);
+	box[2] = fmax(box[2], x);
+	box[3] = fmax(box[3], y);
+}
+
+static int positive(const struct curve_piece* piece, int degree)
+{
+	for (int i = 0; i <= degree; i++)
+		if (!(piece->p[i][2] > 0))
+			return 0;
+
+	return 1;
+}
+
+// With positive weights the projected control points' box contains a rational curve too.
+// Otherwise, e.g. the conics with w <= 0 from bezier_conic_sections, the box is the plane so the piece is split,
+// which makes the weights positive unless the curve passes through infinity.
+static void curve_box(const struct curve_piece* piece, int degree, double box[4])
+{
+	box[0] = box[1] = INFINITY;
+	box[2] = box[3] = -INFINITY;
+
+	if (!positive(piece, degree))
+	{
+		box[0] = box[1] = -INFINITY;
+		box[2] = box[3] = INFINITY;
+
+		return;
+	}
+
+	for (int i = 0; i <= degree; i++)
+		include(box, piece->p[i][0] / piece->p[i][2], piece->p[i][1] / piece->p[i][2]);
+}
+
+static void surface_box(const struct surface_piece* piece, double box[4])
+{
+	box[0] = box[1] = INFINITY;
+	box[2] = box[3] = -INFINITY;
+
+	for (int i = 0; i < 16; i++)
+		include(box, piece->p[i][0], piece->p[i][1]);
+}
+
+// de Casteljau subdivision at the midpoint of degree + 1 points, 'stride' doubles apart with 'size' coordinates each.
+static void halve(const double* p, int degree, int stride, int size, double* low, double* high)
+{
+	double c[4][3];
+
+	for (int i = 0; i <= degree; i++)
+		for (int k = 0; k < size; k++)
+			c[i][k] = p[i * stride + k];
+
+	for (int k = 0; k < size; k++)
+		low[k] = c[0][k];
+
+	for (int k = 0; k < size; k++)
+		high[degree * stride + k] = c[degree][k];
+
+	for (int r = 1; r <= degree; r++)
+	{
+		for (int i = 0; i <= degree - r; i++)
+			for (int k = 0; k < size; k++)
+				c[i][k] = 0.5 * (c[i][k] + c[i + 1][k]);
+
+		for (int k = 0; k < size; k++)
+		{
+			low[r * stride + k] = c[0][k];
+			high[(degree - r) * stride + k] = c[degree - r][k];
+		}
+	}
+}
+
+// Includes the boxes of the curve's pieces, halved until their weights are positive.
+static void split_box(const struct curve_piece* piece, int degree, int splits, double box[4])
+{
+	if (splits == 0 || positive(piece, degree))
+	{
+		double piece_box[4];
+		curve_box(piece, degree, piece_box);
+
+		include(box, piece_box[0], piece_box[1]);
+		include(box, piece_box[2], piece_box[3]);
+
+		return;
+	}
+
+	struct curve_piece half[2];
+	halve(piece->p[0], degree, 3, 3, half[0].p[0], half[1].p[0]);
+
+	split_box(&half[0], degree, splits - 1, box);
+	split_box(&half[1], degree, splits - 1, box);
+}
+
+static void closest_on_curve(const struct curve_piece* curve, int degree, double x, double y, double tolerance, double* best, struct bezier_hit* hit, long patch)
+{
+	struct curve_piece stack[MAX_STACK];
+	int height = 1;
+
+	stack[0] = *curve;
+
+	for (int step = 0; height && step < MAX_STEPS && *best > 2 * tolerance * tolerance; step++)
+	{
+		const struct curve_piece piece = stack[--height];
+
+		double box[4];
+		curve_box(&piece, degree, box);
+
+		if (box_distance(box, x, y) >= *best)
+			continue;
+
+		// The end points are on the curve.
+		for (int end = 0; end < 2; end++)
+		{
+			const double* p = piece.p[end ? degree : 0];
+			const double dx = p[0] / p[2] - x;
+			const double dy = p[1] / p[2] - y;
+
+			if (dx * dx + dy * dy < *best)
+			{
+				*best = dx * dx + dy * dy;
+				*hit = (struct bezier_hit){ .patch = patch, .u = (float)(end ? piece.high : piece.low), .x = (float)(p[0] / p[2]), .y = (float)(p[1] / p[2]) };
+			}
+		}
+
+		if (fmax(box[2] - box[0], box[3] - box[1]) < tolerance || height + 2 > MAX_STACK)
+			continue;
+
+		struct curve_piece half[2];
+		const double mid = 0.5 * (piece.low + piece.high);
+
+		halve(piece.p[0], degree, 3, 3, half[0].p[0], half[1].p[0]);
+		half[0].low = piece.low;
+		half[0].high = half[1].low = mid;
+		half[1].high = piece.high;
+
+		// Visit the nearer half first, the sooner a close point is found the more is rejected.
+		double low_box[4], high_box[4];
+		curve_box(&half[0], degree, low_box);
+		curve_box(&half[1], degree, high_box);
+
+		const int near_high = box_distance(high_box, x, y) < box_distance(low_box, x, y);
+
+		stack[height++] = half[!near_high];
+		stack[height++] = half[near_high];
+	}
+}
+
+static void closest_on_surface(const struct surface_piece* surface, double x, double y, double tolerance, double* best, struct bezier_hit* hit, long patch)
+{
+	struct surface_piece stack[MAX_STACK];
+	int height = 1;
+
+	stack[0] = *surface;
+
+	for (int step = 0; height && step < MAX_STEPS && *best > 2 * tolerance * tolerance; step++)
+	{
+		const struct surface_piece piece = stack[--height];
+
+		double box[4];
+		surface_box(&piece, box);
+
+		if (box_distance(box, x, y) >= *best)
+			continue;
+
+		// The corners are on the surface, point i + 4j is at v[i/3], u[j/3].
+		for (int corner = 0; corner < 4; corner++)
+		{
+			const int i = 3 * (corner & 1), j = 3 * (corner >> 1);
+			const double* p = piece.p[i + 4 * j];
+			const double dx = p[0] - x;
+			const double dy = p[1] - y;
+
+			if (dx * dx + dy * dy < *best)
+			{
+				*best = dx * dx + dy * dy;
+				*hit = (struct bezier_hit){ .patch = patch, .u = (float)piece.u[j / 3], .v = (float)piece.v[i / 3], .x = (float)p[0], .y = (float)p[1] };
+			}
+		}
+
+		if (fmax(box[2] - box[0], box[3] - box[1]) < tolerance || height + 2 > MAX_STACK)
+			continue;
+
+		// Split across the longer direction: u combines the rows (j), v the columns (i).
+		double u_size = 0, v_size = 0;
+
+		for (int k = 0; k < 4; k++)
+		{
+			u_size = fmax(u_size, hypot(piece.p[k + 12][0] - piece.p[k][0], piece.p[k + 12][1] - piece.p[k][1]));
+			v_size = fmax(v_size, hypot(piece.p[4 * k + 3][0] - piece.p[4 * k][0], piece.p[4 * k + 3][1] - piece.p[4 * k][1]));
+		}
+
+		struct surface_piece half[2] = { piece, piece };
+
+		if (u_size >= v_size)
+		{
+			for (int i = 0; i < 4; i++)
+				halve(piece.p[i], 3, 8, 2, half[0].p[i], half[1].p[i]);
+
+			half[0].u[1] = half[1].u[0] = 0.5 * (piece.u[0] + piece.u[1]);
+		}
+		else
+		{
+			for (int j = 0; j < 4; j++)
+				halve(piece.p[4 * j], 3, 2, 2, half[0].p[4 * j], half[1].p[4 * j]);
+
+			half[0].v[1] = half[1].v[0] = 0.5 * (piece.v[0] + piece.v[1]);
+		}
+
+		// Visit the nearer half first, as for curves.
+		double low_box[4], high_box[4];
+		surface_box(&half[0], low_box);
+		surface_box(&half[1], high_box);
+
+		const int near_high = box_distance(high_box, x, y) < box_distance(low_box, x, y);
+
+		stack[height++] = half[!near_high];
+		stack[height++] = half[near_high];
+	}
+}
+
+void bezier_hit_update(struct bezier_hit_tester* tester, size_t patch)
+{
+	const int floats = bezier_patch_floats(tester->type);
+	const float* p = tester->patch + floats * patch;
+	float* box = tester->box + 4 * patch;
+
+	box[0] = box[1] = INFINITY;
+	box[2] = box[3] = -INFINITY;
+
+	const int rational = tester->type == BEZIER_PATCH_RATIONAL_QUADRATIC || tester->type == BEZIER_PATCH_RATIONAL_CUBIC_CURVE;
+
+	if (!rational)
+	{
+		for (int i = 0; i < floats; i += 2)
+		{
+			box[0] = fminf(box[0], p[i]);
+			box[1] = fminf(box[1], p[i + 1]);
+			box[2] = fmaxf(box[2], p[i]);
+			box[3] = fmaxf(box[3], p[i + 1]);
+		}
+
+		return;
+	}
+
+	const int degree = floats / 3 - 1;
+	struct curve_piece curve = { .low = 0, .high = 1 };
+	double curve_box[4] = { INFINITY, INFINITY, -INFINITY, -INFINITY };
+
+	for (int k = 0; k <= degree; k++)
+	{
+		curve.p[k][0] = p[3 * k];
+		curve.p[k][1] = p[3 * k + 1];
+		curve.p[k][2] = p[3 * k + 2];
+	}
+
+	split_box(&curve, degree, MAX_SPLITS, curve_box);
+
+	for (int i = 0; i < 4; i++)
+		box[i] = (float)curve_box[i];
+}
+
+int bezier_hit_init(struct bezier_hit_tester* tester, enum bezier_patch type, size_t count, const float* patch)
+{
+	*tester = (struct bezier_hit_tester){ .type = type, .count = count, .patch = patch };
+
+	if (type != BEZIER_PATCH_CUBIC_CURVE && type != BEZIER_PATCH_RATIONAL_QUADRATIC && type != BEZIER_PATCH_BICUBIC_RECTANGLE && type != BEZIER_PATCH_RATIONAL_CUBIC_CURVE)
+		return 1;
+
+	tester->box = malloc(4 * count * sizeof(float));
+
+	if (!tester->box)
+		return 1;
+
+	for (size_t i = 0; i < count; i++)
+		bezier_hit_update(tester, i);
+
+	return 0;
+}
+
+void bezier_hit_free(struct bezier_hit_tester* tester)
+{
+	free(tester->box);
+	*tester = (struct bezier_hit_tester){ 0 };
+}
+
+int bezier_hit_test(const struct bezier_hit_tester* tester, float x, float y, float radius, struct bezier_hit* hit)
+{
+	const int floats = bezier_patch_floats(tester->type);
+	const double tolerance = TOLERANCE * radius;
+
+	double best = (double)radius * radius;
+	*hit = (struct bezier_hit){ .patch = -1 };
+
+	// Once a point within a piece's diagonal at the tolerance is found the query is on a patch, nothing found later could be told apart.
+	for (size_t i = 0; i < tester->count && best > 2 * tolerance * tolerance; i++)
+	{
+		const float* box = tester->box + 4 * i;
+
+		// Most patches are far away, the comparisons are combined without branching as their outcomes are unpredictable.
+		if ((x < box[0] - radius) | (x > box[2] + radius) | (y < box[1] - radius) | (y > box[3] + radius))
+			continue;
+
+		if (box_distance((const double[4]) { box[0], box[1], box[2], box[3] }, x, y) >= best)
+			continue;
+
+		const float* p = tester->patch + floats * i;
+
+		if (tester->type == BEZIER_PATCH_BICUBIC_RECTANGLE)
+		{
+			struct surface_piece surface = { .u = { 0, 1 }, .v = { 0, 1 } };
+
+			for (int k = 0; k < 16; k++)
+			{
+				surface.p[k][0] = p[2 * k];
+				surface.p[k][1] = p[2 * k + 1];
+			}
+
+			closest_on_surface(&surface, x, y, tolerance, &best, hit, (long)i);
+		}
+		else
+		{
+			const int rational = tester->type != BEZIER_PATCH_CUBIC_CURVE;
+			const int degree = tester->type == BEZIER_PATCH_RATIONAL_QUADRATIC ? 2 : 3;
+			struct curve_piece curve = { .low = 0, .high = 1 };
+
+			for (int k = 0; k <= degree; k++)
+			{
+				curve.p[k][0] = p[(2 + rational) * k];
+				curve.p[k][1] = p[(2 + rational) * k + 1];
+				curve.p[k][2] = rational ? p[3 * k + 2] : 1.0;
+			}
+
+			closest_on_curve(&curve, degree, x, y, tolerance, &best, hit, (long)i);
+		}
+	}
+
+	if (hit->patch >= 0)
+		hit->distance = (float)sqrt(best);
+
+	return hit->patch >= 0;
+}
+
+int bezier_patch_floats(enum bezier_patch type)
+{
+	switch (type)
+	{
+	case BEZIER_PATCH_CUBIC_CURVE:
+		return 8;
+	case BEZIER_PATCH_RATIONAL_QUADRATIC:
+		return 9;
+	case BEZIER_PATCH_CUBIC_TRIANGLE:
+		return 20;
+	case BEZIER_PATCH_RATIONAL_CUBIC_CURVE:
+		return 12;
+	case BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE:
+		return 48;
+	case BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE:
+		return 30;
+	default:
+		return 32;
+	}
+}
+
+void bezier_composite_curve(size_t count, const float* knot, int closed, float* curve)
+{
+	const size_t segments = closed ? count : count - 1;
+
+	for (size_t i = 0; i < segments; i++)
+	{
+		const float* a = knot + 4 * i;
+		const float* b = knot + 4 * ((i + 1) % count);
+		float* c = curve + 8 * i;
+
+		// Matches the composite curve's control shader: the next knot's handle is reflected through its point.
+		c[0] = a[0];
+		c[1] = a[1];
+		c[2] = a[2];
+		c[3] = a[3];
+		c[4] = 2 * b[0] - b[2];
+		c[5] = 2 * b[1] - b[3];
+		c[6] = b[0];
+		c[7] = b[1];
+	}
+}
@@ -0,0 +1,417 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+#include "simd.h"
+
+#include <math.h>
+
+#define TOLERANCE 0.0001f
+#define MAX_ITERATIONS 1000
+
+#define CLIP_SPLIT 0.8
+#define CLIP_TOLERANCE 1e-7
+#define CLIP_MARGIN 1e-9
+#define NEWTON_TOLERANCE 1e-9
+#define NEWTON_ITERATIONS 32
+
+// By the variation diminishing property the curve can only cross zero if the control polygon has both signs.
+// Zero coefficients don't count as a crossing, roots at the endpoints are recorded separately and exact midpoints during subdivision.
+static int discard(const float a[4])
+{
+	return !((a[0] > 0 || a[1] > 0 || a[2] > 0 || a[3] > 0)
+		&& (a[0] < 0 || a[1] < 0 || a[2] < 0 || a[3] < 0));
+}
+
+static void push(float root[3], int* count, float t)
+{
+	if (*count < 3)
+		root[(*count)++] = t;
+}
+
+static void bisection(const float a[4], float root[3], int* count, int* iterations)
+{
+	// Note that the stack height is bound by the variation diminishing property since the subdivision is a piecewise linear interpolation.
+	struct stack_frame {
+		float low, high;
+		float p[4];
+	} stack_base[2], *stack = stack_base;
+
+	float low = 0.0f;
+	float high = 1.0f;
+
+	// Even entries are the control polygon, odd entries scratch for the subdivision.
+	float b[7];
+
+	b[0] = a[0];
+	b[2] = a[1];
+	b[4] = a[2];
+	b[6] = a[3];
+
+	for (int i = 0; i < MAX_ITERATIONS; i++, (*iterations)++)
+	{
+		if (high - low < TOLERANCE)
+		{
+			push(root, count, 0.5f * (low + high));
+
+			if (stack == stack_base)
+				break;
+
+			low = (--stack)->low;
+			high = stack->high;
+
+			b[0] = stack->p[0];
+			b[2] = stack->p[1];
+			b[4] = stack->p[2];
+			b[6] = stack->p[3];
+
+			continue;
+		}
+
+		b[1] = 0.5f * (b[0] + b[2]);
+		b[3] = 0.5f * (b[2] + b[4]);
+		b[5] = 0.5f * (b[4] + b[6]);
+
+		b[2] = 0.5f * (b[1] + b[3]);
+		b[4] = 0.5f * (b[3] + b[5]);
+
+		b[3] = 0.5f * (b[2] + b[4]);
+
+		const float mid = 0.5f * (low + high);
+
+		if (b[3] == 0)
+			push(root, count, mid);
+
+		const int discard_low = discard(b);
+		const int discard_high = discard(b + 3);
+
+		if (discard_low && discard_high)
+		{
+			if (stack == stack_base)
+				break;
+
+			low = (--stack)->low;
+			high = stack->high;
+
+			b[0] = stack->p[0];
+			b[2] = stack->p[1];
+			b[4] = stack->p[2];
+			b[6] = stack->p[3];
+
+			continue;
+		}
+
+		if (discard_high)
+		{
+			b[6] = b[3];
+			b[4] = b[2];
+			b[2] = b[1];
+
+			high = mid;
+
+			continue;
+		}
+
+		if (!discard_low && stack < stack_base + 2)
+			*(stack++) = (struct stack_frame){ .low = low, .high = mid, .p = { b[0], b[1], b[2], b[3] } };
+
+		b[0] = b[3];
+		b[2] = b[4];
+		b[4] = b[5];
+
+		low = mid;
+	}
+}
+
+// Sign changes along the control polygon, skipping zeros. By Descartes' rule for the Bernstein basis
+// the interval holds at most that many roots, and exactly one if there's one change.
+static int variations(const double a[4])
+{
+	int changes = 0;
+	double previous = 0;
+
+	for (int i = 0; i < 4; i++)
+		if (a[i] != 0)
+		{
+			changes += (previous < 0 && a[i] > 0) || (previous > 0 && a[i] < 0);
+			previous = a[i];
+		}
+
+	return changes;
+}
+
+// Parameter range, relative to the polygon, where the convex hull of the points (i/3, b[i]) meets zero.
+// Every hull edge is a segment between two control points so the extremes of the pairwise crossings are the hull's.
+static void hull_range(const double b[4], double* low, double* high)
+{
+	*low = 1.0;
+	*high = 0.0;
+
+	for (int i = 0; i < 4; i++)
+	{
+		if (b[i] == 0)
+		{
+			*low = fmin(*low, i / 3.0);
+			*high = fmax(*high, i / 3.0);
+		}
+
+		for (int j = i + 1; j < 4; j++)
+			if ((b[i] < 0 && b[j] > 0) || (b[i] > 0 && b[j] < 0))
+			{
+				const double t = (i + (j - i) * b[i] / (b[i] - b[j])) / 3.0;
+
+				*low = t < *low ? t : *low;
+				*high = t > *high ? t : *high;
+			}
+	}
+}
+
+// de Casteljau subdivision at t, keeping the part below (keep_high == 0) or above t.
+static void subdivide(double b[4], double t, int keep_high)
+{
+	const double s = 1 - t;
+
+	const double b01 = s * b[0] + t * b[1];
+	const double b12 = s * b[1] + t * b[2];
+	const double b23 = s * b[2] + t * b[3];
+
+	const double b012 = s * b01 + t * b12;
+	const double b123 = s * b12 + t * b23;
+
+	const double b0123 = s * b012 + t * b123;
+
+	if (keep_high)
+	{
+		b[0] = b0123;
+		b[1] = b123;
+		b[2] = b23;
+	}
+	else
+	{
+		b[1] = b01;
+		b[2] = b012;
+		b[3] = b0123;
+	}
+}
+
+static double cubic(const double a[4], double t)
+{
+	const double s = 1 - t;
+
+	return s * s * s * a[0] + 3 * s * s * t * a[1] + 3 * s * t * t * a[2] + t * t * t * a[3];
+}
+
+// Safeguarded Newton iteration on the original cubic from t, falling back to bisection when a step leaves the bracket [low,high].
+static double polish(const double a[4], double low, double high, double t, int* iterations)
+{
+	const int negative_low = cubic(a, low) < 0;
+
+	for (int i = 0; i < NEWTON_ITERATIONS; i++, (*iterations)++)
+	{
+		const double f = cubic(a, t);
+
+		if (f == 0)
+			break;
+
+		if ((f < 0) == negative_low)
+			low = t;
+		else
+			high = t;
+
+		const double s = 1 - t;
+		const double df = 3 * ((a[1] - a[0]) * s * s + 2 * (a[2] - a[1]) * s * t + (a[3] - a[2]) * t * t);
+
+		double next = t - f / df;
+
+		if (df == 0 || !(next > low && next < high))
+			next = 0.5 * (low + high);
+
+		const int converged = fabs(next - t) <= NEWTON_TOLERANCE;
+		t = next;
+
+		if (converged)
+			break;
+	}
+
+	return t;
+}
+
+static void push_unique(float root[3], int* count, float t)
+{
+	for (int i = 0; i < *count; i++)
+		if (fabsf(root[i] - t) <= CLIP_TOLERANCE)
+			return;
+
+	push(root, count, t);
+}
+
+static void clipping(const float a[4], float root[3], int* count, int* iterations)
+{
+	const double p[4] = { a[0], a[1], a[2], a[3] };
+
+	// Each pending interval holds a sign variation, so as with bisection the stack stays shallow.
+	struct stack_frame {
+		double low, high;
+		double b[4];
+	} stack_base[3], *stack = stack_base;
+
+	struct stack_frame current = { .low = 0.0, .high = 1.0, .b = { p[0], p[1], p[2], p[3] } };
+
+	for (int i = 0; i < MAX_ITERATIONS; i++, (*iterations)++)
+	{
+		const int changes = variations(current.b);
+		int done = changes == 0;
+
+		// A single sign change with non-zero ends brackets exactly one simple root, which the Newton iteration can't escape,
+		// so it takes over straight away from where the polygon's chord crosses zero.
+		if (changes == 1 && current.b[0] != 0 && current.b[3] != 0)
+		{
+			const double start = current.low + (current.high - current.low) * current.b[0] / (current.b[0] - current.b[3]);
+
+			push_unique(root, count, (float)polish(p, current.low, current.high, start, iterations));
+			done = 1;
+		}
+		else if (!done && current.high - current.low < CLIP_TOLERANCE)
+		{
+			push_unique(root, count, (float)(0.5 * (current.low + current.high)));
+			done = 1;
+		}
+
+		if (done)
+		{
+			if (stack == stack_base)
+				break;
+
+			current = *(--stack);
+			continue;
+		}
+
+		double low, high;
+		hull_range(current.b, &low, &high);
+
+		const double width = current.high - current.low;
+
+		// Clipping barely helps near multiple roots or when the hull straddles several roots, so split those instead.
+		if (high - low > CLIP_SPLIT && stack < stack_base + 3)
+		{
+			struct stack_frame half = current;
+
+			subdivide(half.b, 0.5, 0);
+			half.high = current.low + 0.5 * width;
+
+			if (variations(half.b))
+				*(stack++) = half;
+
+			subdivide(current.b, 0.5, 1);
+			current.low = half.high;
+
+			continue;
+		}
+
+		// Widen the clipped range slightly so rounding can't push a root sitting on its edge outside.
+		low = fmax(0.0, low - CLIP_MARGIN);
+		high = fmin(1.0, high + CLIP_MARGIN);
+
+		subdivide(current.b, low, 1);
+
+		if (low < 1.0)
+			subdivide(current.b, (high - low) / (1.0 - low), 0);
+
+		current.high = current.low + high * width;
+		current.low = current.low + low * width;
+	}
+}
+
+int bezier_cubic_roots(const float a[4], enum bezier_solver solver, float root[3], int* iterations)
+{
+	int count = 0;
+	int steps = 0;
+
+	if (a[0] == 0)
+		push(root, &count, 0);
+
+	if (a[3] == 0)
+		push(root, &count, 1);
+
+	if (!discard(a))
+	{
+		if (solver == BEZIER_CLIPPING)
+			clipping(a, root, &count, &steps);
+		else
+			bisection(a, root, &count, &steps);
+	}
+
+	if (iterations)
+		*iterations += steps;
+
+	// Roots from the endpoints and the stack aren't found in order.
+	for (int i = 1; i < count; i++)
+		for (int j = i; j > 0 && root[j - 1] > root[j]; j--)
+		{
+			const float t = root[j];
+			root[j] = root[j - 1];
+			root[j - 1] = t;
+		}
+
+	return count;
+}
+
+// Curves are processed a vector of curves at a time: each group is transposed into lanes, moved into the line's frame
+// and rejected with the same variation diminishing test as discard(). Only the surviving curves are subdivided.
+size_t bezier_intersect_lines(size_t count, const float* curve, const float* line, size_t line_stride, enum bezier_solver solver, float* root, int* root_count)
+{
+	size_t total = 0;
+
+	for (size_t i = 0; i < count; i += LANES)
+	{
+		const size_t lanes = count - i < LANES ? count - i : LANES;
+
+		// Control points then line end points, one curve per lane.
+		float in[12][LANES] = { 0 };
+
+		for (size_t k = 0; k < lanes; k++)
+		{
+			for (int j = 0; j < 8; j++)
+				in[j][k] = curve[8 * (i + k) + j];
+
+			for (int j = 0; j < 4; j++)
+				in[8 + j][k] = line[line_stride * (i + k) + j];
+		}
+
+		const vfloat x0 = vload(in[8]);
+		const vfloat y0 = vload(in[9]);
+		const vfloat dx = vsub(vload(in[10]), x0);
+		const vfloat dy = vsub(vload(in[11]), y0);
+
+		// Signed (unnormalized) distance of each control point from the line.
+		float a[4][LANES], low[LANES], high[LANES];
+		vfloat min = vset(0.0f), max = vset(0.0f);
+
+		for (int j = 0; j < 4; j++)
+		{
+			const vfloat d = vsub(vmul(dx, vsub(vload(in[2 * j + 1]), y0)), vmul(dy, vsub(vload(in[2 * j]), x0)));
+
+			min = j ? vmin(min, d) : d;
+			max = j ? vmax(max, d) : d;
+
+			vstore(a[j], d);
+		}
+
+		vstore(low, min);
+		vstore(high, max);
+
+		for (size_t k = 0; k < lanes; k++)
+		{
+			int n = 0;
+
+			if ((low[k] < 0 && high[k] > 0) || a[0][k] == 0 || a[3][k] == 0)
+				n = bezier_cubic_roots((float[4]) { a[0][k], a[1][k], a[2][k], a[3][k] }, solver, root + total, NULL);
+
+			root_count[i + k] = n;
+			total += n;
+		}
+	}
+
+	return total;
+}
@@ -0,0 +1,229 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define INITIAL_CAPACITY 64
+
+int bezier_path_init(struct bezier_path* path)
+{
+	*path = (struct bezier_path){ .knot_capacity = INITIAL_CAPACITY, .subpath_capacity = INITIAL_CAPACITY };
+
+	path->knot = malloc(4 * INITIAL_CAPACITY * sizeof(float));
+	path->ratio = malloc(INITIAL_CAPACITY * sizeof(float));
+	path->subpath_knot = malloc((INITIAL_CAPACITY + 1) * sizeof(size_t));
+	path->subpath_segment = malloc((INITIAL_CAPACITY + 1) * sizeof(size_t));
+	path->closed = malloc(INITIAL_CAPACITY);
+
+	if (!path->knot || !path->ratio || !path->subpath_knot || !path->subpath_segment || !path->closed)
+	{
+		bezier_path_free(path);
+		return 1;
+	}
+
+	path->subpath_knot[0] = path->subpath_segment[0] = 0;
+
+	return 0;
+}
+
+void bezier_path_free(struct bezier_path* path)
+{
+	free(path->knot);
+	free(path->ratio);
+	free(path->subpath_knot);
+	free(path->subpath_segment);
+	free(path->closed);
+
+	*path = (struct bezier_path){ 0 };
+}
+
+// Grows an array to hold capacity elements, leaving it untouched if out of memory.
+static int grow(void** array, size_t capacity, size_t size)
+{
+	void* grown = realloc(*array, capacity * size);
+
+	if (!grown)
+		return 1;
+
+	*array = grown;
+	return 0;
+}
+
+static size_t subpath_segments(const struct bezier_path* path, size_t subpath)
+{
+	const size_t knots = path->subpath_knot[subpath + 1] - path->subpath_knot[subpath];
+
+	if (path->closed[subpath])
+		return knots > 1 ? knots : 0;
+
+	return knots > 0 ? knots - 1 : 0;
+}
+
+int bezier_path_begin(struct bezier_path* path, int closed)
+{
+	if (path->subpath_count == path->subpath_capacity)
+	{
+		const size_t capacity = 2 * path->subpath_capacity;
+
+		if (grow((void**)&path->subpath_knot, capacity + 1, sizeof(size_t)) ||
+			grow((void**)&path->subpath_segment, capacity + 1, sizeof(size_t)) ||
+			grow((void**)&path->closed, capacity, 1))
+			return 1;
+
+		path->subpath_capacity = capacity;
+	}
+
+	const size_t s = path->subpath_count++;
+
+	path->closed[s] = closed != 0;
+	path->subpath_knot[s + 1] = path->knot_count;
+	path->subpath_segment[s + 1] = path->subpath_segment[s];
+
+	return 0;
+}
+
+int bezier_path_add(struct bezier_path* path, const float knot[4], float ratio)
+{
+	if (!path->subpath_count && bezier_path_begin(path, 0))
+		return 1;
+
+	if (path->knot_count == path->knot_capacity)
+	{
+		const size_t capacity = 2 * path->knot_capacity;
+
+		if (grow((void**)&path->knot, 4 * capacity, sizeof(float)) || grow((void**)&path->ratio, capacity, sizeof(float)))
+			return 1;
+
+		path->knot_capacity = capacity;
+	}
+
+	memcpy(path->knot + 4 * path->knot_count, knot, 4 * sizeof(float));
+	path->ratio[path->knot_count++] = ratio;
+
+	// Only the last subpath grows, so only its end markers change.
+	const size_t s = path->subpath_count - 1;
+
+	path->subpath_knot[s + 1] = path->knot_count;
+	path->subpath_segment[s + 1] = path->subpath_segment[s] + subpath_segments(path, s);
+
+	return 0;
+}
+
+int bezier_path_load(struct bezier_path* path, const char* file)
+{
+	FILE* stream = fopen(file, "r");
+
+	if (!stream)
+		return 1;
+
+	char line[256];
+	int failed = 0;
+
+	while (!failed && fgets(line, sizeof(line), stream))
+	{
+		float knot[4], ratio = 1.0f;
+		char word[8];
+
+		const int read = sscanf(line, "%f %f %f %f %f", &knot[0], &knot[1], &knot[2], &knot[3], &ratio);
+
+		if (read >= 4)
+			failed = !(ratio > 0) || bezier_path_add(path, knot, ratio);
+		else if (sscanf(line, "%7s", word) == 1)
+			failed = (strcmp(word, "open") && strcmp(word, "closed")) || bezier_path_begin(path, !strcmp(word, "closed"));
+	}
+
+	failed |= ferror(stream);
+	fclose(stream);
+
+	return failed;
+}
+
+size_t bezier_path_segments(const struct bezier_path* path)
+{
+	return path->subpath_segment[path->subpath_count];
+}
+
+// Subpath holding segment, the last whose first segment isn't after it (skipping empty subpaths).
+static size_t find_subpath(const struct bezier_path* path, size_t segment)
+{
+	size_t low = 0, high = path->subpath_count;
+
+	while (high - low > 1)
+	{
+		const size_t middle = low + (high - low) / 2;
+
+		if (path->subpath_segment[middle] <= segment)
+			low = middle;
+		else
+			high = middle;
+	}
+
+	return low;
+}
+
+// Knots a segment runs between.
+static void segment_knots(const struct bezier_path* path, size_t* subpath, size_t segment, size_t* a, size_t* b)
+{
+	while (segment >= path->subpath_segment[*subpath + 1])
+		++*subpath;
+
+	const size_t first = path->subpath_knot[*subpath];
+	const size_t k = segment - path->subpath_segment[*subpath];
+
+	*a = first + k;
+	*b = *a + 1 < path->subpath_knot[*subpath + 1] ? *a + 1 : first;
+}
+
+size_t bezier_path_indices(const struct bezier_path* path, size_t first, size_t count, unsigned int* index)
+{
+	size_t subpath = find_subpath(path, first);
+	size_t needed = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		size_t a, b;
+		segment_knots(path, &subpath, first + i, &a, &b);
+
+		index[2 * i] = (unsigned int)a;
+		index[2 * i + 1] = (unsigned int)b;
+
+		if (a + 1 > needed)
+			needed = a + 1;
+
+		if (b + 1 > needed)
+			needed = b + 1;
+	}
+
+	return needed;
+}
+
+void bezier_path_curves(const struct bezier_path* path, size_t first, size_t count, float* curve)
+{
+	size_t subpath = find_subpath(path, first);
+
+	for (size_t i = 0; i < count; i++)
+	{
+		size_t a, b;
+		segment_knots(path, &subpath, first + i, &a, &b);
+
+		const float* p = path->knot + 4 * a;
+		const float* q = path->knot + 4 * b;
+		const float r = path->ratio[b];
+		float* c = curve + 8 * i;
+
+		// Matches the composite curve's control shader.
+		c[0] = p[0];
+		c[1] = p[1];
+		c[2] = p[2];
+		c[3] = p[3];
+		c[4] = q[0] + r * (q[0] - q[2]);
+		c[5] = q[1] + r * (q[1] - q[3]);
+		c[6] = q[0];
+		c[7] = q[1];
+	}
+}
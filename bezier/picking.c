@@ -0,0 +1,180 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <math.h>
+#include <stdlib.h>
+
+// Each cell holds a doubly linked list of its points threaded through next and previous, so moving a point is O(1).
+#define NONE -1
+
+static int clamp(int i, int low, int high)
+{
+	return i < low ? low : i > high ? high : i;
+}
+
+// Points outside the bounds are kept in the nearest edge cell.
+static int cell_of(const struct bezier_picker* picker, float x, float y)
+{
+	const int column = clamp((int)floorf((x - picker->low[0]) / picker->cell_size), 0, picker->columns - 1);
+	const int row = clamp((int)floorf((y - picker->low[1]) / picker->cell_size), 0, picker->rows - 1);
+
+	return column + picker->columns * row;
+}
+
+static void link(struct bezier_picker* picker, int point, int cell)
+{
+	picker->cell[point] = cell;
+	picker->previous[point] = NONE;
+	picker->next[point] = picker->head[cell];
+
+	if (picker->head[cell] != NONE)
+		picker->previous[picker->head[cell]] = point;
+
+	picker->head[cell] = point;
+}
+
+static void unlink(struct bezier_picker* picker, int point)
+{
+	const int cell = picker->cell[point];
+
+	if (picker->previous[point] != NONE)
+		picker->next[picker->previous[point]] = picker->next[point];
+	else
+		picker->head[cell] = picker->next[point];
+
+	if (picker->next[point] != NONE)
+		picker->previous[picker->next[point]] = picker->previous[point];
+}
+
+int bezier_picker_init(struct bezier_picker* picker, size_t count, const float* point, const float low[2], const float high[2], float cell_size)
+{
+	*picker = (struct bezier_picker){
+		.low = { low[0], low[1] },
+		.cell_size = cell_size,
+		.columns = (int)ceilf((high[0] - low[0]) / cell_size),
+		.rows = (int)ceilf((high[1] - low[1]) / cell_size),
+		.count = count,
+	};
+
+	if (picker->columns < 1)
+		picker->columns = 1;
+
+	if (picker->rows < 1)
+		picker->rows = 1;
+
+	const size_t cells = (size_t)picker->columns * picker->rows;
+
+	picker->head = malloc(cells * sizeof(int));
+	picker->next = malloc(count * sizeof(int));
+	picker->previous = malloc(count * sizeof(int));
+	picker->cell = malloc(count * sizeof(int));
+	picker->point = malloc(2 * count * sizeof(float));
+
+	if (!picker->head || !picker->next || !picker->previous || !picker->cell || !picker->point)
+	{
+		bezier_picker_free(picker);
+		return 1;
+	}
+
+	for (size_t i = 0; i < cells; i++)
+		picker->head[i] = NONE;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		picker->point[2 * i] = point[2 * i];
+		picker->point[2 * i + 1] = point[2 * i + 1];
+
+		link(picker, (int)i, cell_of(picker, point[2 * i], point[2 * i + 1]));
+	}
+
+	return 0;
+}
+
+void bezier_picker_free(struct bezier_picker* picker)
+{
+	free(picker->head);
+	free(picker->next);
+	free(picker->previous);
+	free(picker->cell);
+	free(picker->point);
+
+	*picker = (struct bezier_picker){ 0 };
+}
+
+void bezier_picker_move(struct bezier_picker* picker, size_t point, float x, float y)
+{
+	picker->point[2 * point] = x;
+	picker->point[2 * point + 1] = y;
+
+	const int cell = cell_of(picker, x, y);
+
+	if (cell == picker->cell[point])
+		return;
+
+	unlink(picker, (int)point);
+	link(picker, (int)point, cell);
+}
+
+// Cells overlapping the box, clamped like the points so points kept in edge cells are still visited.
+static void cell_range(const struct bezier_picker* picker, const float low[2], const float high[2], int range[4])
+{
+	range[0] = clamp((int)floorf((low[0] - picker->low[0]) / picker->cell_size), 0, picker->columns - 1);
+	range[1] = clamp((int)floorf((low[1] - picker->low[1]) / picker->cell_size), 0, picker->rows - 1);
+	range[2] = clamp((int)floorf((high[0] - picker->low[0]) / picker->cell_size), 0, picker->columns - 1);
+	range[3] = clamp((int)floorf((high[1] - picker->low[1]) / picker->cell_size), 0, picker->rows - 1);
+}
+
+long bezier_picker_nearest(const struct bezier_picker* picker, float x, float y, float radius)
+{
+	int range[4];
+	cell_range(picker, (float[2]) { x - radius, y - radius }, (float[2]) { x + radius, y + radius }, range);
+
+	long nearest = -1;
+	float best = radius * radius;
+
+	for (int row = range[1]; row <= range[3]; row++)
+		for (int column = range[0]; column <= range[2]; column++)
+			for (int i = picker->head[column + picker->columns * row]; i != NONE; i = picker->next[i])
+			{
+				const float dx = picker->point[2 * i] - x;
+				const float dy = picker->point[2 * i + 1] - y;
+				const float distance = dx * dx + dy * dy;
+
+				// Ties go to the higher index, matching the demonstrations' scans where the last match wins.
+				if (distance < best || (distance == best && i > nearest))
+				{
+					best = distance;
+					nearest = i;
+				}
+			}
+
+	return nearest;
+}
+
+size_t bezier_picker_box(const struct bezier_picker* picker, const float low[2], const float high[2], size_t* selection, size_t capacity)
+{
+	int range[4];
+	cell_range(picker, low, high, range);
+
+	size_t total = 0;
+
+	for (int row = range[1]; row <= range[3]; row++)
+		for (int column = range[0]; column <= range[2]; column++)
+			for (int i = picker->head[column + picker->columns * row]; i != NONE; i = picker->next[i])
+			{
+				const float* p = picker->point + 2 * i;
+
+				if (p[0] < low[0] || p[0] > high[0] || p[1] < low[1] || p[1] > high[1])
+					continue;
+
+				if (total < capacity)
+					selection[total] = i;
+
+				total++;
+			}
+
+	return total;
+}
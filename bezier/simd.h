@@ -0,0 +1,126 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// Minimal vector abstraction shared by the batch kernels.
+// Kernels are written once against these macros and processed LANES parameters at a time,
+// remainders are padded out to a full vector rather than having a separate scalar loop.
+
+#ifndef BEZIER_SIMD_H
+#define BEZIER_SIMD_H
+
+#if defined(__AVX2__)
+
+#include <immintrin.h>
+
+#define SIMD_NAME "avx2"
+#define LANES 8
+
+typedef __m256 vfloat;
+
+#define vload(p) _mm256_loadu_ps(p)
+#define vstore(p, a) _mm256_storeu_ps(p, a)
+#define vset(a) _mm256_set1_ps(a)
+#define vadd(a, b) _mm256_add_ps(a, b)
+#define vsub(a, b) _mm256_sub_ps(a, b)
+#define vmul(a, b) _mm256_mul_ps(a, b)
+#define vdiv(a, b) _mm256_div_ps(a, b)
+#define vmin(a, b) _mm256_min_ps(a, b)
+#define vmax(a, b) _mm256_max_ps(a, b)
+#define vsqrt(a) _mm256_sqrt_ps(a)
+
+#if defined(__FMA__)
+#define vfma(a, b, c) _mm256_fmadd_ps(a, b, c)
+#else
+#define vfma(a, b, c) _mm256_add_ps(_mm256_mul_ps(a, b), c)
+#endif
+
+#elif defined(__SSE2__) || defined(_M_X64)
+
+#include <emmintrin.h>
+
+#define SIMD_NAME "sse2"
+#define LANES 4
+
+typedef __m128 vfloat;
+
+#define vload(p) _mm_loadu_ps(p)
+#define vstore(p, a) _mm_storeu_ps(p, a)
+#define vset(a) _mm_set1_ps(a)
+#define vadd(a, b) _mm_add_ps(a, b)
+#define vsub(a, b) _mm_sub_ps(a, b)
+#define vmul(a, b) _mm_mul_ps(a, b)
+#define vdiv(a, b) _mm_div_ps(a, b)
+#define vmin(a, b) _mm_min_ps(a, b)
+#define vmax(a, b) _mm_max_ps(a, b)
+#define vsqrt(a) _mm_sqrt_ps(a)
+#define vfma(a, b, c) _mm_add_ps(_mm_mul_ps(a, b), c)
+
+#elif defined(__ARM_NEON)
+
+#include <arm_neon.h>
+
+#define SIMD_NAME "neon"
+#define LANES 4
+
+typedef float32x4_t vfloat;
+
+#define vload(p) vld1q_f32(p)
+#define vstore(p, a) vst1q_f32(p, a)
+#define vset(a) vdupq_n_f32(a)
+#define vadd(a, b) vaddq_f32(a, b)
+#define vsub(a, b) vsubq_f32(a, b)
+#define vmul(a, b) vmulq_f32(a, b)
+#define vmin(a, b) vminq_f32(a, b)
+#define vmax(a, b) vmaxq_f32(a, b)
+
+#if defined(__aarch64__)
+#define vdiv(a, b) vdivq_f32(a, b)
+#define vfma(a, b, c) vfmaq_f32(c, a, b)
+#define vsqrt(a) vsqrtq_f32(a)
+#else
+static inline float32x4_t vdiv(float32x4_t a, float32x4_t b)
+{
+	float32x4_t r = vrecpeq_f32(b);
+	r = vmulq_f32(vrecpsq_f32(b, r), r);
+	r = vmulq_f32(vrecpsq_f32(b, r), r);
+
+	return vmulq_f32(a, r);
+}
+
+// a times its refined reciprocal square root estimate, positive arguments only.
+static inline float32x4_t vsqrt(float32x4_t a)
+{
+	float32x4_t r = vrsqrteq_f32(a);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+	r = vmulq_f32(vrsqrtsq_f32(vmulq_f32(a, r), r), r);
+
+	return vmulq_f32(a, r);
+}
+#define vfma(a, b, c) vmlaq_f32(c, a, b)
+#endif
+
+#else
+
+#include <math.h>
+
+#define SIMD_NAME "scalar"
+#define LANES 1
+
+typedef float vfloat;
+
+#define vload(p) (*(p))
+#define vstore(p, a) (*(p) = (a))
+#define vset(a) ((float)(a))
+#define vadd(a, b) ((a) + (b))
+#define vsub(a, b) ((a) - (b))
+#define vmul(a, b) ((a) * (b))
+#define vdiv(a, b) ((a) / (b))
+#define vmin(a, b) ((a) < (b) ? (a) : (b))
+#define vmax(a, b) ((a) > (b) ? (a) : (b))
+#define vfma(a, b, c) ((a) * (b) + (c))
+#define vsqrt(a) sqrtf(a)
+
+#endif
+
+#endif
@@ -0,0 +1,371 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#define MAX_THREADS 64
+#define CACHE_LINE 64
+
+// Ring of batches from one thread to another, each index is only written by one side.
+// Storing the tail publishes the slot written before it, storing the head frees the slot read before it.
+struct ring
+{
+	struct bezier_batch** slot;
+	size_t mask;
+
+	_Atomic size_t head;
+	char head_padding[CACHE_LINE];
+	_Atomic size_t tail;
+	char tail_padding[CACHE_LINE];
+};
+
+// A thread's share of the current batch, the items [begin,end) packed in one word so taking from the front and stealing from the back race safely.
+struct share
+{
+	_Atomic uint64_t range;
+	char padding[CACHE_LINE - sizeof(uint64_t)];
+};
+
+struct worker
+{
+	struct bezier_stage* stage;
+	int index;
+};
+
+struct bezier_stage
+{
+	int threads;
+	size_t capacity;
+	size_t in_flight;
+
+	struct ring input;
+	struct ring output;
+
+	// The leader sleeps on 'submitted' only when the input is empty, helpers on 'started' between batches.
+	// Stopping, the leader finishes the input before the helpers are released.
+	mtx_t lock;
+	cnd_t submitted;
+	cnd_t started;
+	unsigned int generation;
+	int stopping;
+	int stopped;
+
+	struct bezier_batch* batch;
+	_Atomic int working;
+
+	thrd_t thread[MAX_THREADS];
+	struct worker worker[MAX_THREADS];
+	struct share share[MAX_THREADS];
+};
+
+static int ring_init(struct ring* ring, size_t capacity)
+{
+	size_t size = 1;
+
+	while (size < capacity)
+		size *= 2;
+
+	ring->slot = malloc(size * sizeof(struct bezier_batch*));
+	ring->mask = size - 1;
+	atomic_init(&ring->head, 0);
+	atomic_init(&ring->tail, 0);
+
+	return !ring->slot;
+}
+
+static int ring_push(struct ring* ring, struct bezier_batch* batch)
+{
+	const size_t tail = atomic_load_explicit(&ring->tail, memory_order_relaxed);
+
+	if (tail - atomic_load_explicit(&ring->head, memory_order_acquire) > ring->mask)
+		return 1;
+
+	ring->slot[tail & ring->mask] = batch;
+	atomic_store_explicit(&ring->tail, tail + 1, memory_order_release);
+
+	return 0;
+}
+
+static struct bezier_batch* ring_pop(struct ring* ring)
+{
+	const size_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+
+	if (head == atomic_load_explicit(&ring->tail, memory_order_acquire))
+		return NULL;
+
+	struct bezier_batch* batch = ring->slot[head & ring->mask];
+	atomic_store_explicit(&ring->head, head + 1, memory_order_release);
+
+	return batch;
+}
+
+static uint64_t pack(size_t begin, size_t end)
+{
+	return (uint64_t)begin << 32 | (uint64_t)end;
+}
+
+// Takes up to grain items from the front of a share.
+static int take(struct share* share, size_t grain, size_t* begin, size_t* end)
+{
+	uint64_t range = atomic_load(&share->range);
+
+	for (;;)
+	{
+		const size_t b = (size_t)(range >> 32), e = (size_t)(range & UINT32_MAX);
+
+		if (b >= e)
+			return 0;
+
+		const size_t n = e - b < grain ? e - b : grain;
+
+		if (atomic_compare_exchange_weak(&share->range, &range, pack(b + n, e)))
+		{
+			*begin = b;
+			*end = b + n;
+
+			return 1;
+		}
+	}
+}
+
+// Moves the back half of the next share that isn't empty to the thief's own, which is.
+static int steal(struct bezier_stage* stage, int thief)
+{
+	for (int i = 1; i < stage->threads; i++)
+	{
+		struct share* victim = &stage->share[(thief + i) % stage->threads];
+		uint64_t range = atomic_load(&victim->range);
+
+		for (;;)
+		{
+			const size_t b = (size_t)(range >> 32), e = (size_t)(range & UINT32_MAX);
+
+			if (b >= e)
+				break;
+
+			const size_t middle = b + (e - b) / 2;
+
+			if (atomic_compare_exchange_weak(&victim->range, &range, pack(b, middle)))
+			{
+				atomic_store(&stage->share[thief].range, pack(middle, e));
+				return 1;
+			}
+		}
+	}
+
+	return 0;
+}
+
+// Runs the current batch until no share has items left, items taken by others may still be running.
+static void work(struct bezier_stage* stage, int index)
+{
+	struct bezier_batch* batch = stage->batch;
+	const size_t grain = batch->grain ? batch->grain : 1;
+
+	for (;;)
+	{
+		size_t begin, end;
+
+		if (take(&stage->share[index], grain, &begin, &end))
+			batch->function(batch, begin, end);
+		else if (!steal(stage, index))
+			return;
+	}
+}
+
+static int helper(void* argument)
+{
+	struct worker* worker = argument;
+	struct bezier_stage* stage = worker->stage;
+	unsigned int seen = 0;
+
+	for (;;)
+	{
+		mtx_lock(&stage->lock);
+
+		while (stage->generation == seen && !stage->stopped)
+			cnd_wait(&stage->started, &stage->lock);
+
+		if (stage->generation == seen)
+		{
+			mtx_unlock(&stage->lock);
+			return 0;
+		}
+
+		seen = stage->generation;
+		mtx_unlock(&stage->lock);
+
+		work(stage, worker->index);
+		atomic_fetch_sub(&stage->working, 1);
+	}
+}
+
+static void run(struct bezier_stage* stage, struct bezier_batch* batch)
+{
+	const int threads = stage->threads;
+
+	for (int t = 0; t < threads; t++)
+		atomic_store(&stage->share[t].range, pack(batch->count * t / threads, batch->count * (t + 1) / threads));
+
+	stage->batch = batch;
+	atomic_store(&stage->working, threads - 1);
+
+	mtx_lock(&stage->lock);
+	stage->generation++;
+	cnd_broadcast(&stage->started);
+	mtx_unlock(&stage->lock);
+
+	work(stage, 0);
+
+	// The helpers are finishing their last ranges, not waiting for more.
+	while (atomic_load(&stage->working))
+		thrd_yield();
+}
+
+static int leader(void* argument)
+{
+	struct bezier_stage* stage = argument;
+
+	for (;;)
+	{
+		struct bezier_batch* batch;
+
+		mtx_lock(&stage->lock);
+
+		while (!(batch = ring_pop(&stage->input)) && !stage->stopping)
+			cnd_wait(&stage->submitted, &stage->lock);
+
+		mtx_unlock(&stage->lock);
+
+		if (!batch)
+			return 0;
+
+		run(stage, batch);
+
+		// The caller may reuse the batch as soon as it's pushed.
+		void (*finished)(void* context) = batch->finished;
+		void* context = batch->context;
+
+		// The output holds as many batches as can be in flight.
+		ring_push(&stage->output, batch);
+
+		if (finished)
+			finished(context);
+	}
+}
+
+static void stop(struct bezier_stage* stage, int helpers, int started_leader)
+{
+	mtx_lock(&stage->lock);
+	stage->stopping = 1;
+	cnd_broadcast(&stage->submitted);
+	mtx_unlock(&stage->lock);
+
+	if (started_leader)
+		thrd_join(stage->thread[0], NULL);
+
+	mtx_lock(&stage->lock);
+	stage->stopped = 1;
+	cnd_broadcast(&stage->started);
+	mtx_unlock(&stage->lock);
+
+	for (int i = 1; i <= helpers; i++)
+		thrd_join(stage->thread[i], NULL);
+}
+
+struct bezier_stage* bezier_stage_create(int threads, size_t capacity)
+{
+	struct bezier_stage* stage = calloc(1, sizeof(struct bezier_stage));
+
+	if (!stage)
+		return NULL;
+
+	stage->capacity = capacity ? capacity : 1;
+
+	if (ring_init(&stage->input, stage->capacity) || ring_init(&stage->output, stage->capacity) ||
+		mtx_init(&stage->lock, mtx_plain) != thrd_success || cnd_init(&stage->submitted) != thrd_success || cnd_init(&stage->started) != thrd_success)
+	{
+		free(stage->input.slot);
+		free(stage->output.slot);
+		free(stage);
+
+		return NULL;
+	}
+
+	threads = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+
+	// Batches are split between the threads that start.
+	int helpers = 0;
+
+	while (helpers < threads - 1)
+	{
+		struct worker* worker = &stage->worker[helpers + 1];
+		*worker = (struct worker){ .stage = stage, .index = helpers + 1 };
+
+		if (thrd_create(&stage->thread[helpers + 1], helper, worker) != thrd_success)
+			break;
+
+		helpers++;
+	}
+
+	stage->threads = helpers + 1;
+
+	if (thrd_create(&stage->thread[0], leader, stage) != thrd_success)
+	{
+		stop(stage, helpers, 0);
+		bezier_stage_destroy(stage);
+
+		return NULL;
+	}
+
+	return stage;
+}
+
+void bezier_stage_destroy(struct bezier_stage* stage)
+{
+	if (!stage)
+		return;
+
+	if (!stage->stopped)
+		stop(stage, stage->threads - 1, 1);
+
+	cnd_destroy(&stage->started);
+	cnd_destroy(&stage->submitted);
+	mtx_destroy(&stage->lock);
+
+	free(stage->input.slot);
+	free(stage->output.slot);
+	free(stage);
+}
+
+int bezier_stage_submit(struct bezier_stage* stage, struct bezier_batch* batch)
+{
+	if (stage->in_flight == stage->capacity || batch->count > UINT32_MAX)
+		return 1;
+
+	ring_push(&stage->input, batch);
+	stage->in_flight++;
+
+	// Taking the lock orders the push before the leader's check of the input, so the wake up isn't lost.
+	mtx_lock(&stage->lock);
+	cnd_signal(&stage->submitted);
+	mtx_unlock(&stage->lock);
+
+	return 0;
+}
+
+struct bezier_batch* bezier_stage_take(struct bezier_stage* stage)
+{
+	struct bezier_batch* batch = ring_pop(&stage->output);
+
+	if (batch)
+		stage->in_flight--;
+
+	return batch;
+}
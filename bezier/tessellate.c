@@ -0,0 +1,598 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "bezier.h"
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include <stdlib.h>
+#include <threads.h>
+
+#define ALIGNMENT 32
+#define MAX_THREADS 64
+
+int bezier_arena_init(struct bezier_arena* arena, size_t capacity)
+{
+	*arena = (struct bezier_arena){ .base = malloc(capacity), .capacity = capacity };
+
+	if (!arena->base)
+		arena->capacity = 0;
+
+	return !arena->base;
+}
+
+void* bezier_arena_alloc(struct bezier_arena* arena, size_t size)
+{
+	const uintptr_t address = (uintptr_t)(arena->base + arena->used);
+	const size_t start = arena->used + ((ALIGNMENT - address % ALIGNMENT) % ALIGNMENT);
+
+	if (start > arena->capacity || size > arena->capacity - start)
+		return NULL;
+
+	arena->used = start + size;
+
+	return arena->base + start;
+}
+
+void bezier_arena_reset(struct bezier_arena* arena)
+{
+	arena->used = 0;
+}
+
+void bezier_arena_free(struct bezier_arena* arena)
+{
+	free(arena->base);
+	*arena = (struct bezier_arena){ 0 };
+}
+
+// The domain of one patch: gl_TessCoord of each vertex and the primitives' indices (offset by 'base').
+// Without arrays the vertices and indices are only counted.
+struct domain
+{
+	float* u;
+	float* v;
+	float* w;
+	unsigned int* index;
+	unsigned int base;
+
+	size_t vertices;
+	size_t indices;
+};
+
+static unsigned int vertex(struct domain* domain, float u, float v, float w)
+{
+	if (domain->u)
+	{
+		domain->u[domain->vertices] = u;
+		domain->v[domain->vertices] = v;
+		domain->w[domain->vertices] = w;
+	}
+
+	return (unsigned int)domain->vertices++;
+}
+
+static void line(struct domain* domain, unsigned int a, unsigned int b)
+{
+	if (domain->index)
+	{
+		domain->index[domain->indices] = domain->base + a;
+		domain->index[domain->indices + 1] = domain->base + b;
+	}
+
+	domain->indices += 2;
+}
+
+static void triangle(struct domain* domain, unsigned int a, unsigned int b, unsigned int c)
+{
+	if (domain->index)
+	{
+		domain->index[domain->indices] = domain->base + a;
+		domain->index[domain->indices + 1] = domain->base + b;
+		domain->index[domain->indices + 2] = domain->base + c;
+	}
+
+	domain->indices += 3;
+}
+
+// Equal spacing clamps a level to [1, BEZIER_MAX_LEVEL] and rounds it up to an integer.
+static int round_level(float level)
+{
+	return (int)ceilf(fminf(fmaxf(level, 1.0f), (float)BEZIER_MAX_LEVEL));
+}
+
+// One side of a ring, its vertices listed in the direction the ring is walked (counter-clockwise).
+struct side
+{
+	int segments;
+	unsigned int index[BEZIER_MAX_LEVEL + 1];
+};
+
+// Triangulates the strip between a ring's side and the parallel side of the next ring in (of no segments if it is a point),
+// advancing along whichever side's next midpoint comes first. The GL leaves the triangulation to the implementation, but the count is always the same.
+static void stitch(struct domain* domain, const struct side* outer, const struct side* inner)
+{
+	const int so = outer->segments;
+	const int si = inner->segments;
+
+	for (int i = 0, j = 0; i < so || j < si;)
+		if (j == si || (i < so && (2 * i + 1) * si <= (2 * j + 1) * so))
+		{
+			triangle(domain, outer->index[i], outer->index[i + 1], inner->index[j]);
+			i++;
+		}
+		else
+		{
+			triangle(domain, outer->index[i], inner->index[j + 1], inner->index[j]);
+			j++;
+		}
+}
+
+// 'isolines': outer[0] lines at v = j / lines, each of outer[1] segments.
+static void isolines(struct domain* domain, const struct bezier_levels* levels)
+{
+	const int lines = round_level(levels->outer[0]);
+	const int segments = round_level(levels->outer[1]);
+
+	for (int j = 0; j < lines; j++)
+	{
+		const unsigned int first = vertex(domain, 0.0f, (float)j / lines, 0.0f);
+
+		for (int i = 1; i <= segments; i++)
+		{
+			vertex(domain, (float)i / segments, (float)j / lines, 0.0f);
+			line(domain, first + i - 1, first + i);
+		}
+	}
+}
+
+// The rectangle k rings in spans u in [k/m, 1 - k/m] and v in [k/n, 1 - k/n] with m - 2k by n - 2k segments,
+// a zero count collapses it to the line (or point) through the centre.
+static void quad_ring(struct domain* domain, int k, int m, int n, struct side side[4])
+{
+	const int a = m - 2 * k;
+	const int b = n - 2 * k;
+
+#define GRID(i, j) vertex(domain, (float)(k + (i)) / m, (float)(k + (j)) / n, 0.0f)
+
+	side[0].segments = side[2].segments = a;
+	side[1].segments = side[3].segments = b;
+
+	if (a > 0 && b > 0)
+	{
+		for (int i = 0; i < a; i++)
+			side[0].index[i] = GRID(i, 0);
+
+		for (int j = 0; j < b; j++)
+			side[1].index[j] = GRID(a, j);
+
+		for (int i = 0; i < a; i++)
+			side[2].index[i] = GRID(a - i, b);
+
+		for (int j = 0; j < b; j++)
+			side[3].index[j] = GRID(0, b - j);
+
+		// Each corner is the start of a side, and the end of the one before.
+		side[0].index[a] = side[1].index[0];
+		side[1].index[b] = side[2].index[0];
+		side[2].index[a] = side[3].index[0];
+		side[3].index[b] = side[0].index[0];
+	}
+	else if (a > 0)
+	{
+		for (int i = 0; i <= a; i++)
+			side[0].index[i] = side[2].index[a - i] = GRID(i, 0);
+
+		side[1].index[0] = side[0].index[a];
+		side[3].index[0] = side[0].index[0];
+	}
+	else
+	{
+		for (int j = 0; j <= b; j++)
+			side[1].index[j] = side[3].index[b - j] = GRID(0, j);
+
+		side[0].index[0] = side[1].index[0];
+		side[2].index[0] = side[1].index[b];
+	}
+
+#undef GRID
+}
+
+// 'quads, equal_spacing, ccw': outer[0..3] subdivide the edges u = 0, v = 0, u = 1 and v = 1, inner[0] and inner[1] the interior along u and v.
+// Concentric rings are stitched together until the centre is a line or point, or a strip one segment wide that is split into quads.
+static void quads(struct domain* domain, const struct bezier_levels* levels)
+{
+	int o[4];
+
+	for (int i = 0; i < 4; i++)
+		o[i] = round_level(levels->outer[i]);
+
+	int m = round_level(levels->inner[0]);
+	int n = round_level(levels->inner[1]);
+
+	if (m == 1 && n == 1 && o[0] == 1 && o[1] == 1 && o[2] == 1 && o[3] == 1)
+	{
+		vertex(domain, 0.0f, 0.0f, 0.0f);
+		vertex(domain, 1.0f, 0.0f, 0.0f);
+		vertex(domain, 1.0f, 1.0f, 0.0f);
+		vertex(domain, 0.0f, 1.0f, 0.0f);
+
+		triangle(domain, 0, 1, 2);
+		triangle(domain, 0, 2, 3);
+		return;
+	}
+
+	// Otherwise an inner level of one is treated as slightly more, which equal spacing rounds up to two.
+	m = m < 2 ? 2 : m;
+	n = n < 2 ? 2 : n;
+
+	struct side outer[4], inner[4];
+
+	outer[0].segments = o[1];
+	outer[1].segments = o[2];
+	outer[2].segments = o[3];
+	outer[3].segments = o[0];
+
+	for (int i = 0; i < o[1]; i++)
+		outer[0].index[i] = vertex(domain, (float)i / o[1], 0.0f, 0.0f);
+
+	for (int j = 0; j < o[2]; j++)
+		outer[1].index[j] = vertex(domain, 1.0f, (float)j / o[2], 0.0f);
+
+	for (int i = 0; i < o[3]; i++)
+		outer[2].index[i] = vertex(domain, 1.0f - (float)i / o[3], 1.0f, 0.0f);
+
+	for (int j = 0; j < o[0]; j++)
+		outer[3].index[j] = vertex(domain, 0.0f, 1.0f - (float)j / o[0], 0.0f);
+
+	outer[0].index[o[1]] = outer[1].index[0];
+	outer[1].index[o[2]] = outer[2].index[0];
+	outer[2].index[o[3]] = outer[3].index[0];
+	outer[3].index[o[0]] = outer[0].index[0];
+
+	for (int k = 1;; k++)
+	{
+		const int a = m - 2 * k;
+		const int b = n - 2 * k;
+
+		quad_ring(domain, k, m, n, inner);
+
+		for (int s = 0; s < 4; s++)
+			stitch(domain, &outer[s], &inner[s]);
+
+		if (a <= 0 || b <= 0)
+			return;
+
+		if (a == 1)
+		{
+			for (int j = 0; j < b; j++)
+			{
+				triangle(domain, inner[3].index[b - j], inner[1].index[j], inner[1].index[j + 1]);
+				triangle(domain, inner[3].index[b - j], inner[1].index[j + 1], inner[3].index[b - j - 1]);
+			}
+
+			return;
+		}
+
+		if (b == 1)
+		{
+			for (int i = 0; i < a; i++)
+			{
+				triangle(domain, inner[0].index[i], inner[0].index[i + 1], inner[2].index[a - i - 1]);
+				triangle(domain, inner[0].index[i], inner[2].index[a - i - 1], inner[2].index[a - i]);
+			}
+
+			return;
+		}
+
+		memcpy(outer, inner, sizeof(outer));
+	}
+}
+
+// Vertex i of s along the side of the triangle k rings in from corner 'from' to corner 'to' (0, 1, 2 for u, v, w).
+// The ring is the outer triangle scaled by (n - 2k) / n about the centre.
+static unsigned int triangle_vertex(struct domain* domain, int k, int n, int from, int to, int i, int s)
+{
+	const float scale = (float)(n - 2 * k) / n;
+	const float t = s ? (float)i / s : 0.0f;
+
+	float c[3];
+
+	for (int axis = 0; axis < 3; axis++)
+	{
+		const float a = (axis == from) - 1.0f / 3.0f;
+		const float b = (axis == to) - 1.0f / 3.0f;
+
+		c[axis] = k ? 1.0f / 3.0f + scale * ((1.0f - t) * a + t * b) : (1.0f - t) * (axis == from) + t * (axis == to);
+	}
+
+	return vertex(domain, c[0], c[1], c[2]);
+}
+
+// The sides of the triangle k rings in, from u to v (w = 0 on the outside), v to w and w to u, with s segments each
+// (or the outer levels on the outside, where 'segments' is already set).
+static void triangle_ring(struct domain* domain, int k, int n, int s, struct side side[3])
+{
+	if (k)
+		side[0].segments = side[1].segments = side[2].segments = s;
+
+	if (k && s == 0)
+	{
+		side[0].index[0] = side[1].index[0] = side[2].index[0] = vertex(domain, 1.0f / 3.0f, 1.0f / 3.0f, 1.0f / 3.0f);
+		return;
+	}
+
+	for (int e = 0; e < 3; e++)
+		for (int i = 0; i < side[e].segments; i++)
+			side[e].index[i] = triangle_vertex(domain, k, n, e, (e + 1) % 3, i, side[e].segments);
+
+	for (int e = 0; e < 3; e++)
+		side[e].index[side[e].segments] = side[(e + 1) % 3].index[0];
+}
+
+// 'triangles, equal_spacing, ccw': outer[0..2] subdivide the edges u = 0, v = 0 and w = 0, inner[0] the interior.
+// Rings are stitched together until the centre is a point or a single triangle.
+static void triangles(struct domain* domain, const struct bezier_levels* levels)
+{
+	struct side outer[3], inner[3];
+
+	outer[0].segments = round_level(levels->outer[2]);
+	outer[1].segments = round_level(levels->outer[0]);
+	outer[2].segments = round_level(levels->outer[1]);
+
+	int n = round_level(levels->inner[0]);
+
+	if (n == 1 && outer[0].segments == 1 && outer[1].segments == 1 && outer[2].segments == 1)
+	{
+		vertex(domain, 1.0f, 0.0f, 0.0f);
+		vertex(domain, 0.0f, 1.0f, 0.0f);
+		vertex(domain, 0.0f, 0.0f, 1.0f);
+
+		triangle(domain, 0, 1, 2);
+		return;
+	}
+
+	n = n < 2 ? 2 : n;
+
+	triangle_ring(domain, 0, n, 0, outer);
+
+	for (int k = 1;; k++)
+	{
+		const int s = n - 2 * k;
+
+		triangle_ring(domain, k, n, s, inner);
+
+		for (int e = 0; e < 3; e++)
+			stitch(domain, &outer[e], &inner[e]);
+
+		if (s <= 0)
+			return;
+
+		if (s == 1)
+		{
+			triangle(domain, inner[0].index[0], inner[1].index[0], inner[2].index[0]);
+			return;
+		}
+
+		memcpy(outer, inner, sizeof(outer));
+	}
+}
+
+// Rational patches are tessellated as their polynomial forms.
+static enum bezier_patch polynomial(enum bezier_patch type)
+{
+	switch (type)
+	{
+	case BEZIER_PATCH_RATIONAL_QUADRATIC:
+	case BEZIER_PATCH_RATIONAL_CUBIC_CURVE:
+		return BEZIER_PATCH_CUBIC_CURVE;
+	case BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE:
+		return BEZIER_PATCH_BICUBIC_RECTANGLE;
+	case BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE:
+		return BEZIER_PATCH_CUBIC_TRIANGLE;
+	default:
+		return type;
+	}
+}
+
+// As the GL does, a patch with an outer level that isn't positive (or is NaN) is discarded.
+static void tessellate_domain(enum bezier_patch type, const struct bezier_levels* levels, struct domain* domain)
+{
+	type = polynomial(type);
+
+	const int outer = type == BEZIER_PATCH_BICUBIC_RECTANGLE ? 4 : type == BEZIER_PATCH_CUBIC_TRIANGLE ? 3 : 2;
+
+	for (int i = 0; i < outer; i++)
+		if (!(levels->outer[i] > 0))
+			return;
+
+	if (type == BEZIER_PATCH_BICUBIC_RECTANGLE)
+		quads(domain, levels);
+	else if (type == BEZIER_PATCH_CUBIC_TRIANGLE)
+		triangles(domain, levels);
+	else
+		isolines(domain, levels);
+}
+
+struct job
+{
+	enum bezier_patch type;
+	const float* patch;
+	const struct bezier_levels* levels;
+	struct bezier_mesh* mesh;
+
+	size_t begin, end;
+
+	// Gives each patch's vertex and index counts when counting, otherwise holds u, v, w, x, y for the largest patch.
+	size_t largest;
+	float* scratch;
+};
+
+static int count_patches(void* argument)
+{
+	struct job* job = argument;
+
+	for (size_t i = job->begin; i < job->end; i++)
+	{
+		struct domain domain = { 0 };
+		tessellate_domain(job->type, job->levels + i, &domain);
+
+		job->mesh->vertex_offset[i + 1] = domain.vertices;
+		job->mesh->index_offset[i + 1] = domain.indices;
+	}
+
+	return 0;
+}
+
+static int tessellate_patches(void* argument)
+{
+	struct job* job = argument;
+	struct bezier_mesh* mesh = job->mesh;
+	const int floats = bezier_patch_floats(job->type);
+
+	float* u = job->scratch;
+	float* v = u + job->largest;
+	float* w = v + job->largest;
+	float* x = w + job->largest;
+	float* y = x + job->largest;
+
+	for (size_t i = job->begin; i < job->end; i++)
+	{
+		struct domain domain = {
+			.u = u, .v = v, .w = w,
+			.index = mesh->index + mesh->index_offset[i],
+			.base = (unsigned int)mesh->vertex_offset[i],
+		};
+
+		tessellate_domain(job->type, job->levels + i, &domain);
+
+		const float* p = job->patch + (size_t)floats * i;
+		const size_t count = domain.vertices;
+
+		switch (job->type)
+		{
+		case BEZIER_PATCH_CUBIC_CURVE:
+			bezier_cubic_curve(p, count, u, x, y);
+			break;
+		case BEZIER_PATCH_RATIONAL_QUADRATIC:
+			bezier_rational_quadratic(p, count, u, x, y);
+			break;
+		case BEZIER_PATCH_BICUBIC_RECTANGLE:
+			bezier_bicubic_rectangle(p, count, u, v, x, y);
+			break;
+		case BEZIER_PATCH_CUBIC_TRIANGLE:
+			bezier_cubic_triangle(p, count, u, v, w, x, y);
+			break;
+		case BEZIER_PATCH_RATIONAL_CUBIC_CURVE:
+			bezier_rational_cubic_curve(p, count, u, x, y);
+			break;
+		case BEZIER_PATCH_RATIONAL_BICUBIC_RECTANGLE:
+			bezier_rational_bicubic_rectangle(p, count, u, v, x, y);
+			break;
+		case BEZIER_PATCH_RATIONAL_CUBIC_TRIANGLE:
+			bezier_rational_cubic_triangle(p, count, u, v, w, x, y);
+			break;
+		}
+
+		float* out = mesh->vertex + BEZIER_VERTEX_FLOATS * mesh->vertex_offset[i];
+
+		for (size_t k = 0; k < count; k++, out += BEZIER_VERTEX_FLOATS)
+		{
+			out[0] = x[k];
+			out[1] = y[k];
+			out[2] = u[k];
+			out[3] = v[k];
+			out[4] = w[k];
+		}
+	}
+
+	return 0;
+}
+
+// Runs job 0 on the calling thread and the rest on their own, any that can't be started also run here.
+static void run_jobs(struct job* job, int count, thrd_start_t function)
+{
+	thrd_t thread[MAX_THREADS];
+	int started[MAX_THREADS] = { 0 };
+
+	for (int i = 1; i < count; i++)
+		started[i] = thrd_create(&thread[i], function, &job[i]) == thrd_success;
+
+	function(&job[0]);
+
+	for (int i = 1; i < count; i++)
+		if (started[i])
+			thrd_join(thread[i], NULL);
+		else
+			function(&job[i]);
+}
+
+int bezier_tessellate(enum bezier_patch type, size_t count, const float* patch, const struct bezier_levels* levels, int threads, struct bezier_arena* arena, struct bezier_mesh* mesh)
+{
+	*mesh = (struct bezier_mesh){ .patches = count, .primitive_vertices = polynomial(type) == BEZIER_PATCH_CUBIC_CURVE ? 2 : 3 };
+
+	threads = threads < 1 ? 1 : threads > MAX_THREADS ? MAX_THREADS : threads;
+
+	if ((size_t)threads > count)
+		threads = count ? (int)count : 1;
+
+	mesh->vertex_offset = bezier_arena_alloc(arena, (count + 1) * sizeof(size_t));
+	mesh->index_offset = bezier_arena_alloc(arena, (count + 1) * sizeof(size_t));
+
+	if (!mesh->vertex_offset || !mesh->index_offset)
+		return 1;
+
+	struct job job[MAX_THREADS];
+
+	for (int t = 0; t < threads; t++)
+		job[t] = (struct job){ .type = type, .patch = patch, .levels = levels, .mesh = mesh, .begin = count * t / threads, .end = count * (t + 1) / threads };
+
+	run_jobs(job, threads, count_patches);
+
+	mesh->vertex_offset[0] = mesh->index_offset[0] = 0;
+
+	size_t largest = 0;
+
+	for (size_t i = 0; i < count; i++)
+	{
+		largest = mesh->vertex_offset[i + 1] > largest ? mesh->vertex_offset[i + 1] : largest;
+
+		mesh->vertex_offset[i + 1] += mesh->vertex_offset[i];
+		mesh->index_offset[i + 1] += mesh->index_offset[i];
+	}
+
+	mesh->vertex_count = mesh->vertex_offset[count];
+	mesh->index_count = mesh->index_offset[count];
+
+	if (mesh->vertex_count > UINT32_MAX)
+		return 1;
+
+	mesh->vertex = bezier_arena_alloc(arena, BEZIER_VERTEX_FLOATS * mesh->vertex_count * sizeof(float));
+	mesh->index = bezier_arena_alloc(arena, mesh->index_count * sizeof(unsigned int));
+
+	if ((mesh->vertex_count && !mesh->vertex) || (mesh->index_count && !mesh->index))
+		return 1;
+
+	// Patches can differ a lot in size, so split them between the threads by vertex count.
+	size_t i = 0;
+
+	for (int t = 0; t < threads; t++)
+	{
+		job[t].begin = i;
+
+		while (i < count && (t == threads - 1 || mesh->vertex_offset[i + 1] * threads <= mesh->vertex_count * (t + 1)))
+			i++;
+
+		job[t].end = i;
+		job[t].largest = largest;
+		job[t].scratch = bezier_arena_alloc(arena, 5 * largest * sizeof(float));
+
+		if (largest && !job[t].scratch)
+			return 1;
+	}
+
+	run_jobs(job, threads, tessellate_patches);
+
+	return 0;
+}
@@ -4,7 +4,11 @@
 
 #include <SDL.h>
 #include <gl/glew.h>
+#include "../bezier/bezier.h"
 #include <stdio.h>
+#include <string.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT 480
@@ -13,14 +17,38 @@ SDL_Window* window = NULL;
 
 GLuint VAO = 0;
 GLuint VBO = 0;
+GLuint EBO = 0;
 
 GLuint program = 0;
 
+// Index of the control points in pixels for picking, build with ../bezier/picking.c.
+struct bezier_picker picker;
+
+// Control points are streamed through a persistently mapped buffer holding RING_SIZE copies of them.
+// Each frame writes the copy drawn longest ago, first waiting on its fence in case the GPU is still reading it,
+// and only copies the range of floats changed since that copy was last written.
+#define RING_SIZE 3
+
+GLfloat* mapped = NULL;
+GLsync fence[RING_SIZE] = { 0 };
+int ring_index = 0;
+size_t dirty_low[RING_SIZE];
+size_t dirty_high[RING_SIZE];
+
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
+// The surface is a mesh of mesh_size by mesh_size patches where neighbouring patches share their edge's control points.
+// The points form a (3 * mesh_size + 1) square grid and each patch indexes its 16 points from it.
+int mesh_size = 1;
+int point_count = 16;
+GLfloat* control_points = NULL;
+
 int init_sdl()
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 || 
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4) < 0 ||
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,3) < 0 ||
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,4) < 0 ||
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE) < 0)
 	{
 		fprintf(stderr, "could not initialize sdl2: %s\n", SDL_GetError());
@@ -119,15 +147,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (
-		attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
-		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER))
+		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -147,34 +180,124 @@ int init_program()
 		return 1;
 	}
 
+	cache_save(program);
+
 	glPatchParameteri(GL_PATCH_VERTICES, 16);
-	glPatchParameterfv(GL_PATCH_DEFAULT_OUTER_LEVEL, (GLfloat[4]) { 16, 16, 16,16 });
-	glPatchParameterfv(GL_PATCH_DEFAULT_INNER_LEVEL, (GLfloat[2]) { 8,8 });
+
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	return 0;
+}
+
+void mark_dirty(size_t low, size_t high)
+{
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		dirty_low[i] = low < dirty_low[i] ? low : dirty_low[i];
+		dirty_high[i] = high > dirty_high[i] ? high : dirty_high[i];
+	}
+}
+
+int init_ring()
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr size = RING_SIZE * (2 * point_count) * sizeof(GLfloat);
+
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+
+	mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+
+	if (!mapped)
+	{
+		printf("Unable to map the control point buffer\n");
+		return 1;
+	}
+
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		dirty_low[i] = 0;
+		dirty_high[i] = (2 * point_count);
+	}
 
 	return 0;
 }
 
+// Writes the changed control points to the next copy, returns the copy's first vertex.
+GLint upload()
+{
+	ring_index = (ring_index + 1) % RING_SIZE;
+
+	if (fence[ring_index])
+	{
+		while (glClientWaitSync(fence[ring_index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+		glDeleteSync(fence[ring_index]);
+		fence[ring_index] = 0;
+	}
+
+	if (dirty_low[ring_index] < dirty_high[ring_index])
+		memcpy(mapped + ring_index * (2 * point_count) + dirty_low[ring_index], control_points + dirty_low[ring_index],
+			(dirty_high[ring_index] - dirty_low[ring_index]) * sizeof(GLfloat));
+
+	dirty_low[ring_index] = (2 * point_count);
+	dirty_high[ring_index] = 0;
+
+	return ring_index * ((2 * point_count) / 2);
+}
+
 void render()
 {
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	const GLint first = upload();
+
 	glUseProgram(program);
-	glDrawArrays(GL_PATCHES,0, 16);	
+	profile_begin(0);
+	glDrawElementsBaseVertex(GL_PATCHES, 16 * mesh_size * mesh_size, GL_UNSIGNED_INT, NULL, first);
+	profile_end(0);
 
 	glUseProgram(0);
-	glDrawArrays(GL_POINTS,0, 16);
+	profile_begin(1);
+	glDrawArrays(GL_POINTS, first, point_count);
+	profile_end(1);
+
+	fence[ring_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
+}
+
+// Moves control point i to the pixel (x, y), the drain loop calls it once a frame with the drag's latest position.
+void move_point(int i, int x, int y)
+{
+	control_points[2 * i] = 2.0f * ((float)x) / ((float)SCREEN_WIDTH) - 1.0f;
+	control_points[2 * i + 1] = 1.0f - 2.0f * ((float)y) / ((float)SCREEN_HEIGHT);
+
+	bezier_picker_move(&picker, i, (float)x, (float)y);
+
+	mark_dirty(2 * i, 2 * i + 2);
 }
 
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
+	if (argc > 2 && atoi(args[2]) > 0)
+		mesh_size = atoi(args[2]);
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
+	profile_init();
+
 	SDL_Event e;
 	int vertex_selection = -1;
 
@@ -187,56 +310,127 @@ int main(int argc, char* args[])
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
 	glEnableVertexAttribArray(0);
+	// The patches are polynomial, see the vertex shader.
+	glVertexAttrib1f(1, 1.0f);
 
-	GLfloat control_points[32];
+	const int side = 3 * mesh_size + 1;
+	point_count = side * side;
+
+	control_points = malloc(2 * point_count * sizeof(GLfloat));
+	GLuint* indices = malloc(16 * mesh_size * mesh_size * sizeof(GLuint));
+
+	if (!control_points || !indices)
+	{
+		printf("Unable to allocate a mesh of size %d\n", mesh_size);
+		return 0;
+	}
 
-	for (size_t i = 0; i < 4; i++)
-		for (size_t j = 0; j < 4; j++)
+	for (int i = 0; i < side; i++)
+		for (int j = 0; j < side; j++)
 		{
-			control_points[2 * i + 8 * j] = -0.5 + 1.0/3.0 * (GLfloat)i;
-			control_points[2 * i + 8 * j + 1] = -0.5 + 1.0/3.0 * (GLfloat)j;
+			control_points[2 * i + 2 * side * j] = -0.5 + 1.0 / (side - 1) * (GLfloat)i;
+			control_points[2 * i + 2 * side * j + 1] = -0.5 + 1.0 / (side - 1) * (GLfloat)j;
 		}
 
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	// Patch (i,j) starts at grid point (3i,3j), so its last row and column are the first of its neighbours'.
+	for (int i = 0; i < mesh_size; i++)
+		for (int j = 0; j < mesh_size; j++)
+			for (int k = 0; k < 16; k++)
+				indices[16 * (i + mesh_size * j) + k] = 3 * i + k % 4 + side * (3 * j + k / 4);
+
+	if (init_ring())
+		return 0;
+
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-	glBufferData(GL_ARRAY_BUFFER, 2 * 16 * sizeof(GLfloat), control_points, GL_STATIC_DRAW);
+
+	GLfloat* pixels = malloc(2 * point_count * sizeof(GLfloat));
+
+	if (!pixels)
+		return 0;
+
+	for (int i = 0; i < point_count; i++)
+	{
+		pixels[2 * i] = SCREEN_WIDTH * (0.5f + 0.5f * control_points[2 * i]);
+		pixels[2 * i + 1] = SCREEN_HEIGHT * (0.5f - 0.5f * control_points[2 * i + 1]);
+	}
+
+	const int picker_failed = bezier_picker_init(&picker, point_count, pixels, (float[2]) { 0, 0 }, (float[2]) { SCREEN_WIDTH, SCREEN_HEIGHT }, 8);
+	free(pixels);
+
+	if (picker_failed)
+	{
+		printf("Unable to allocate the picker\n");
+		return 0;
+	}
+
+	glGenBuffers(1, &EBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 16 * mesh_size * mesh_size * sizeof(GLuint), indices, GL_STATIC_DRAW);
+
+	free(indices);
 
 	glPointSize(6);
 	render();
 
 	while (SDL_WaitEvent(&e))
 	{
-		if (e.type == SDL_QUIT)
-			break;
+		profile_cpu_start = SDL_GetPerformanceCounter();
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = 0;
+		int pending = -1, pending_x = 0, pending_y = 0;
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 16; i++)
-			{
-				const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_points[2 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_points[2 * i + 1]) - e.button.y;
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-					vertex_selection = i;
+			// The drag's latest position is applied before the selection changes.
+			if ((e.type == SDL_MOUSEBUTTONUP || e.type == SDL_MOUSEBUTTONDOWN) && pending >= 0)
+			{
+				move_point(pending, pending_x, pending_y);
+				pending = -1;
 			}
 
-		if (e.type == SDL_MOUSEMOTION)
-		{
-			if (vertex_selection < 0)
-				continue;
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
+
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+				vertex_selection = (int)bezier_picker_nearest(&picker, (float)e.button.x, (float)e.button.y, 3);
+
+			if (e.type == SDL_MOUSEMOTION)
+			{
+				if (vertex_selection < 0)
+					continue;
+
+				profile_event(e.motion.timestamp);
 
-			control_points[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_points[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+				pending = vertex_selection;
+				pending_x = e.motion.x;
+				pending_y = e.motion.y;
+				moved = 1;
+			}
+		} while (SDL_PollEvent(&e));
 
-			glBufferData(GL_ARRAY_BUFFER, 2 * 16 * sizeof(GLfloat), control_points, GL_STATIC_DRAW);
+		if (pending >= 0)
+			move_point(pending, pending_x, pending_y);
 
+		if (quit)
+			break;
+
+		if (moved)
+		{
 			render();
 		}
 	}
 
+	bezier_picker_free(&picker);
+	free(control_points);
+
+	if (profile_log)
+		fclose(profile_log);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
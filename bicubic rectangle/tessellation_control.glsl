@@ -0,0 +1,107 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#version 430
+layout (vertices = 16) out;
+
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// When set the control points are converted to power basis coefficients for the evaluation shader, as in 'cubic curve'.
+// The patches' edges are then no longer exact so a mesh can crack.
+uniform bool power_basis = false;
+
+const float bernstein_to_power[16] = float[16](
+	 1, 0, 0, 0,
+	-3, 3, 0, 0,
+	 3,-6, 3, 0,
+	-1, 3,-3, 1);
+
+// The line strip through n uniform samples of a cubic is within 3/4 max|P_i - 2P_{i+1} + P_{i+2}| / n^2 of the curve.
+// Rational edges are measured as in 'cubic curve', on their projected points with the bound scaled by w_max / w_min.
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float cubic_level(vec2 p0, vec2 p1, vec2 p2, vec2 p3, float ratio)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	p0 *= scale;
+	p1 *= scale;
+	p2 *= scale;
+	p3 *= scale;
+
+	precise float flatness = ratio * max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	precise float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	precise float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+// Patches of a mesh may traverse a shared edge in opposite directions and the formula above rounds differently when reversed,
+// so edges are always measured from their lexicographically smaller end point.
+float cubic_level(int i, int stride)
+{
+	vec4 q0 = gl_in[i].gl_Position;
+	vec4 q1 = gl_in[i + stride].gl_Position;
+	vec4 q2 = gl_in[i + 2 * stride].gl_Position;
+	vec4 q3 = gl_in[i + 3 * stride].gl_Position;
+
+	precise vec2 p0 = q0.xy / q0.w;
+	precise vec2 p1 = q1.xy / q1.w;
+	precise vec2 p2 = q2.xy / q2.w;
+	precise vec2 p3 = q3.xy / q3.w;
+
+	precise float ratio = max(max(q0.w, q1.w), max(q2.w, q3.w)) / min(min(q0.w, q1.w), min(q2.w, q3.w));
+
+	if (p3.x < p0.x || (p3.x == p0.x && p3.y < p0.y))
+		return cubic_level(p3, p2, p1, p0, ratio);
+
+	return cubic_level(p0, p1, p2, p3, ratio);
+}
+
+//  0, 1, 2, 3
+//  4, 5, 6, 7
+//  8, 9,10,11
+// 12,13,14,15
+//
+// gl_TessCoord.x moves down the rows and gl_TessCoord.y along them, see the evaluation shader.
+// Each outer level only depends on its own edge's points, computed in a canonical order with 'precise' arithmetic,
+// so patches sharing an edge in a mesh agree on it and the mesh has no cracks.
+
+void main(void)
+{
+	if(gl_InvocationID == 0)
+	{
+		gl_TessLevelOuter[0] = cubic_level(0, 1);
+		gl_TessLevelOuter[1] = cubic_level(0, 4);
+		gl_TessLevelOuter[2] = cubic_level(12, 1);
+		gl_TessLevelOuter[3] = cubic_level(3, 4);
+
+		gl_TessLevelInner[0] = max(max(cubic_level(0, 4), cubic_level(1, 4)), max(cubic_level(2, 4), cubic_level(3, 4)));
+		gl_TessLevelInner[1] = max(max(cubic_level(0, 1), cubic_level(4, 1)), max(cubic_level(8, 1), cubic_level(12, 1)));
+	}
+
+	// Coefficient k + 4j is of x^j y^k, converting the rows (j) and then the columns (k).
+	if (power_basis)
+	{
+		int j = gl_InvocationID / 4;
+		int k = gl_InvocationID % 4;
+		vec4 c = vec4(0.0);
+
+		for (int a = 0; a < 4; a++)
+		for (int b = 0; b < 4; b++)
+			c += bernstein_to_power[4 * j + a] * bernstein_to_power[4 * k + b] * gl_in[b + 4 * a].gl_Position;
+
+		gl_out[gl_InvocationID].gl_Position = c;
+	}
+	else
+		gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+}
\ No newline at end of file
@@ -6,24 +6,60 @@
 layout(quads, equal_spacing, ccw) in;
 layout (location = 0) out vec2 tessCoord;
 
+// Unlike mix() this is exact at t = 0 and t = 1, so a patch's edge only depends on the edge's control points
+// and neighbouring patches of a mesh place the vertices of a shared edge identically.
+vec3 lerp(vec3 a, vec3 b, float t)
+{
+	precise vec3 c = (1.0 - t) * a + t * b;
+	return c;
+}
+
+precise gl_Position;
+
+// See the control shader.
+uniform bool power_basis = false;
+
 void main(void)
 {
    tessCoord = gl_TessCoord.xy;
 
-   vec2 buff[16];
+	// Each row is a cubic in x, which are then combined as a cubic in y.
+	if (power_basis)
+	{
+		vec3 row[4];
+
+		for (int k = 0; k < 4; k++)
+		{
+			row[k] = gl_in[k + 12].gl_Position.xyw;
+
+			for (int j = 2; j >= 0; j--)
+				row[k] = row[k] * gl_TessCoord.x + gl_in[k + 4 * j].gl_Position.xyw;
+		}
+
+		vec3 c = row[3];
+
+		for (int k = 2; k >= 0; k--)
+			c = c * gl_TessCoord.y + row[k];
+
+		gl_Position = vec4(c.xy,0,c.z);
+		return;
+	}
+
+   // Homogeneous (w*x, w*y, w), the division is left to the GL.
+   vec3 buff[16];
 
    	for (int i = 0; i < 16; i++)
-		buff[i] = gl_in[i].gl_Position.xy;
+		buff[i] = gl_in[i].gl_Position.xyw;
 
 	for (int i = 3; i > 0; i--)
 	for (int j = 0; j < i; j++)
 	for (int k = 0; k < 4; k++)
-		buff[k + 4 * j] = mix(buff[k + 4 * j],buff[k + 4 * j+4],gl_TessCoord.x);
+		buff[k + 4 * j] = lerp(buff[k + 4 * j],buff[k + 4 * j+4],gl_TessCoord.x);
 
 	for (int i = 3; i > 0; i--)
 	for (int j = 0; j < i; j++)
-		buff[j] = mix(buff[j],buff[j+1],gl_TessCoord.y);
+		buff[j] = lerp(buff[j],buff[j+1],gl_TessCoord.y);
 
 
-	gl_Position = vec4(buff[0],0,1);
+	gl_Position = vec4(buff[0].xy,0,buff[0].z);
 }
\ No newline at end of file
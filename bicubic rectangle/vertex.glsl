@@ -6,7 +6,11 @@
 
 layout(location = 0) in vec2 position;
 
+// Rational patches upload homogeneous points (w*x, w*y) with their weight w here,
+// polynomial ones leave the array disabled and set its current value to 1.
+layout(location = 1) in float weight;
+
 void main()
 {
-	gl_Position = vec4( position, 0, 1 );
+	gl_Position = vec4( position, 0, weight );
 }
\ No newline at end of file
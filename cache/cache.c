@@ -0,0 +1,153 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "cache.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static char cache_path[1024];
+static int cache_missed = 0;
+
+// FNV-1a, including the terminator so consecutive strings can't run together.
+static unsigned long long hash_bytes(unsigned long long hash, const char* bytes, size_t size)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= (unsigned char)bytes[i];
+		hash *= 0x100000001b3ULL;
+	}
+
+	return hash;
+}
+
+static unsigned long long hash_string(unsigned long long hash, const char* string)
+{
+	return string ? hash_bytes(hash, string, strlen(string) + 1) : hash;
+}
+
+// Returns 0 if the file was read into the hash.
+static int hash_file(unsigned long long* hash, const char* file)
+{
+	FILE* stream;
+
+	fopen_s(&stream, file, "rb");
+
+	if (!stream)
+		return 1;
+
+	char buffer[4096];
+	size_t size;
+
+	while ((size = fread(buffer, 1, sizeof(buffer), stream)) > 0)
+		*hash = hash_bytes(*hash, buffer, size);
+
+	*hash = hash_bytes(*hash, "", 1);
+	fclose(stream);
+
+	return 0;
+}
+
+static int load_binary(GLuint program, const char* path)
+{
+	FILE* stream;
+
+	fopen_s(&stream, path, "rb");
+
+	if (!stream)
+		return 1;
+
+	GLenum format = 0;
+	fseek(stream, 0L, SEEK_END);
+	const long size = ftell(stream) - (long)sizeof(format);
+	fseek(stream, 0L, SEEK_SET);
+
+	void* binary = size > 0 ? malloc(size) : NULL;
+	const int read = binary && fread(&format, sizeof(format), 1, stream) == 1 && fread(binary, 1, size, stream) == (size_t)size;
+
+	fclose(stream);
+
+	GLint status = GL_FALSE;
+
+	if (read)
+	{
+		glProgramBinary(program, format, binary, (GLsizei)size);
+		glGetProgramiv(program, GL_LINK_STATUS, &status);
+	}
+
+	free(binary);
+
+	return status != GL_TRUE;
+}
+
+int cache_load(GLuint program, int count, const char* const* file)
+{
+	const char* directory = getenv("TESSELLATION_CACHE");
+	GLint formats = 0;
+
+	cache_missed = 0;
+
+	if (!directory)
+		return 1;
+
+	glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formats);
+
+	if (formats < 1)
+		return 1;
+
+	unsigned long long hash = 0xcbf29ce484222325ULL;
+
+	hash = hash_string(hash, (const char*)glGetString(GL_VENDOR));
+	hash = hash_string(hash, (const char*)glGetString(GL_RENDERER));
+	hash = hash_string(hash, (const char*)glGetString(GL_VERSION));
+	hash = hash_string(hash, (const char*)glGetString(GL_SHADING_LANGUAGE_VERSION));
+
+	// An unreadable shader is reported when it's attached.
+	for (int i = 0; i < count; i++)
+		if (hash_file(&hash, file[i]))
+			return 1;
+
+	snprintf(cache_path, sizeof(cache_path), "%s/%016llx.bin", directory, hash);
+
+	if (!load_binary(program, cache_path))
+		return 0;
+
+	// A rejected binary leaves the program unlinked, so the shaders can still be attached.
+	glProgramParameteri(program, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+	cache_missed = 1;
+
+	return 1;
+}
+
+void cache_save(GLuint program)
+{
+	if (!cache_missed)
+		return;
+
+	cache_missed = 0;
+
+	GLint size = 0;
+	glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &size);
+
+	void* binary = size > 0 ? malloc(size) : NULL;
+
+	if (!binary)
+		return;
+
+	GLenum format = 0;
+	glGetProgramBinary(program, size, &size, &format, binary);
+
+	FILE* stream;
+
+	fopen_s(&stream, cache_path, "wb");
+
+	if (!stream || fwrite(&format, sizeof(format), 1, stream) != 1 || fwrite(binary, 1, size, stream) != (size_t)size)
+		printf("Unable to write: %s\n", cache_path);
+
+	if (stream)
+		fclose(stream);
+
+	free(binary);
+}
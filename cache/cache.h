@@ -0,0 +1,22 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// The demonstrations' program binary cache, included by each main.c and built from cache/cache.c.
+#ifndef CACHE_H
+#define CACHE_H
+
+#include <gl/glew.h>
+
+// Opt-in, enabled by naming an existing directory in the TESSELLATION_CACHE environment variable.
+// Programs are named by an FNV-1a hash of their shaders' sources and the driver's strings, so editing a shader or updating the driver misses the cache.
+// A file holds the binary's format followed by the binary, as the benchmark's -c cache.
+
+// Loads the program built from the count shader files from the cache, returns 0 if it's linked.
+// Otherwise (a miss, a binary the driver rejects or the cache disabled) the shaders are attached and linked as usual, then cache_save.
+int cache_load(GLuint program, int count, const char* const* file);
+
+// Writes the program cache_load last missed to the cache.
+void cache_save(GLuint program);
+
+#endif
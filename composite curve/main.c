@@ -4,7 +4,10 @@
 
 #include <SDL.h>
 #include <gl/glew.h>
+#include "../bezier/bezier.h"
 #include <stdio.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT SCREEN_WIDTH
@@ -14,10 +17,18 @@ SDL_Window* window = NULL;
 GLuint VBO = 0;
 GLuint VAO[2] = { 0 };
 GLuint IBO = 0;
+GLuint ratio_buffer = 0;
+GLuint command_buffer = 0;
 
 GLuint program = 0;
 
-GLfloat control_point[] = {
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
+// The path drawn, the closed curve through these three knots unless a path file is given.
+struct bezier_path path;
+
+GLfloat initial_knot[] = {
 	-0.5, -0.5, 
 	-0.5, -0.9, 
 	 0.0,  0.5, 
@@ -26,6 +37,26 @@ GLfloat control_point[] = {
 	 0.5, -0.9,
 };
 
+// Paths are streamed to the GPU a chunk of segments per frame, so a path of millions of segments is drawn while it uploads.
+// The segments uploaded so far are drawn with one glDrawElementsIndirect call whose command's count grows as they arrive.
+#define STREAM_CHUNK 65536
+
+size_t streamed_segments = 0;
+size_t uploaded_knots = 0;
+
+// Every knot's point and handle in pixels, point 2i + 1 being knot i's handle, so clicks don't scan the path.
+struct bezier_picker picker;
+
+// Layout read by glDrawElementsIndirect.
+struct draw_elements_command
+{
+	GLuint count;
+	GLuint instance_count;
+	GLuint first_index;
+	GLint base_vertex;
+	GLuint base_instance;
+};
+
 int init_sdl()
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 || 
@@ -129,15 +160,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
 		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
-		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER))
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -157,44 +193,211 @@ int init_program()
 		return 1;
 	}
 
+	cache_save(program);
+
 	glPatchParameteri(GL_PATCH_VERTICES, 2);
 
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+
 	return 0;
 }
 
+int init_path(const char* file)
+{
+	if (bezier_path_init(&path))
+		return 1;
+
+	if (file)
+	{
+		if (bezier_path_load(&path, file))
+		{
+			printf("Unable to read path: %s\n", file);
+			return 1;
+		}
+
+		return 0;
+	}
+
+	if (bezier_path_begin(&path, 1))
+		return 1;
+
+	for (int i = 0; i < 3; i++)
+		if (bezier_path_add(&path, initial_knot + 4 * i, 1.0f))
+			return 1;
+
+	return 0;
+}
+
+int init_picker()
+{
+	GLfloat* pixels = malloc(4 * path.knot_count * sizeof(GLfloat));
+
+	if (!pixels)
+		return 1;
+
+	for (size_t i = 0; i < 2 * path.knot_count; i++)
+	{
+		pixels[2 * i] = SCREEN_WIDTH * (0.5f + 0.5f * path.knot[2 * i]);
+		pixels[2 * i + 1] = SCREEN_HEIGHT * (0.5f - 0.5f * path.knot[2 * i + 1]);
+	}
+
+	const int picker_failed = bezier_picker_init(&picker, 2 * path.knot_count, pixels, (float[2]) { 0, 0 }, (float[2]) { SCREEN_WIDTH, SCREEN_HEIGHT }, 8);
+	free(pixels);
+
+	if (picker_failed)
+		printf("Unable to allocate the picker\n");
+
+	return picker_failed;
+}
+
+// Buffers sized for the whole path, filled by stream_chunk.
+int init_buffers()
+{
+	const size_t segments = bezier_path_segments(&path);
+
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferData(GL_ARRAY_BUFFER, 4 * path.knot_count * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+
+	glGenBuffers(1, &ratio_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, ratio_buffer);
+	glBufferData(GL_ARRAY_BUFFER, path.knot_count * sizeof(GLfloat), NULL, GL_STATIC_DRAW);
+
+	glGenBuffers(1, &IBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 2 * segments * sizeof(GLuint), NULL, GL_STATIC_DRAW);
+
+	const struct draw_elements_command command = { 0, 1, 0, 0, 0 };
+
+	glGenBuffers(1, &command_buffer);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	glBufferData(GL_DRAW_INDIRECT_BUFFER, sizeof(command), &command, GL_DYNAMIC_DRAW);
+
+	return glGetError() != GL_NO_ERROR;
+}
+
+// Writes the next chunk's indices straight into the index buffer, uploads the knots they need and extends the draw command.
+// Returns 0 once the whole path is uploaded.
+int stream_chunk()
+{
+	const size_t segments = bezier_path_segments(&path);
+	const size_t count = segments - streamed_segments < STREAM_CHUNK ? segments - streamed_segments : STREAM_CHUNK;
+
+	size_t needed = uploaded_knots;
+
+	if (count)
+	{
+		// Nothing drawn reads this range yet so there's no need to synchronize.
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+		GLuint* index = glMapBufferRange(GL_ELEMENT_ARRAY_BUFFER, 2 * streamed_segments * sizeof(GLuint), 2 * count * sizeof(GLuint),
+			GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT);
+
+		if (!index)
+			return 0;
+
+		needed = bezier_path_indices(&path, streamed_segments, count, index);
+		glUnmapBuffer(GL_ELEMENT_ARRAY_BUFFER);
+	}
+
+	// Knots no segment uses (e.g. lone knots) are uploaded with the last chunk for the overlay.
+	if (streamed_segments + count == segments)
+		needed = path.knot_count;
+
+	if (needed > uploaded_knots)
+	{
+		glBindBuffer(GL_ARRAY_BUFFER, VBO);
+		glBufferSubData(GL_ARRAY_BUFFER, 4 * uploaded_knots * sizeof(GLfloat), 4 * (needed - uploaded_knots) * sizeof(GLfloat), path.knot + 4 * uploaded_knots);
+
+		glBindBuffer(GL_ARRAY_BUFFER, ratio_buffer);
+		glBufferSubData(GL_ARRAY_BUFFER, uploaded_knots * sizeof(GLfloat), (needed - uploaded_knots) * sizeof(GLfloat), path.ratio + uploaded_knots);
+
+		uploaded_knots = needed;
+	}
+
+	streamed_segments += count;
+
+	const GLuint index_count = (GLuint)(2 * streamed_segments);
+
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	glBufferSubData(GL_DRAW_INDIRECT_BUFFER, 0, sizeof(index_count), &index_count);
+
+	return streamed_segments < segments || uploaded_knots < path.knot_count;
+}
+
 void render()
 {
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	glUseProgram(program);
+	profile_begin(0);
 	glBindVertexArray(VAO[1]);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-	glDrawElements(GL_PATCHES, 6, GL_UNSIGNED_INT, NULL);
+	glBindBuffer(GL_DRAW_INDIRECT_BUFFER, command_buffer);
+	glDrawElementsIndirect(GL_PATCHES, GL_UNSIGNED_INT, NULL);
+	profile_end(0);
 
 	glUseProgram(0);
+	profile_begin(1);
 	glBindVertexArray(VAO[0]);
-	glDrawArrays(GL_LINES, 0, 6);
-	glDrawArrays(GL_POINTS, 0, 6);
+	glDrawArrays(GL_LINES, 0, (GLsizei)(2 * uploaded_knots));
+	glDrawArrays(GL_POINTS, 0, (GLsizei)(2 * uploaded_knots));
+	profile_end(1);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
+}
+
+// Moves point i to the pixel (x, y), its handle keeping the offset when it's a P_0, and uploads the edited knot.
+// The drain loop calls it once a frame with the drag's latest position.
+void move_point(long i, int x, int y, const GLfloat offset[2])
+{
+	path.knot[2 * i] = 2.0f * ((float)x) / ((float)SCREEN_WIDTH) - 1.0f;
+	path.knot[2 * i + 1] = 1.0f - 2.0f * ((float)y) / ((float)SCREEN_HEIGHT);
+
+	bezier_picker_move(&picker, i, (float)x, (float)y);
+
+	// If moving P_0 point move the P_1 point.
+	if (i % 2 == 0)
+	{
+		path.knot[2 * i + 2] = path.knot[2 * i] + offset[0];
+		path.knot[2 * i + 3] = path.knot[2 * i + 1] + offset[1];
+
+		bezier_picker_move(&picker, i + 1, SCREEN_WIDTH * (0.5f + 0.5f * path.knot[2 * i + 2]), SCREEN_HEIGHT * (0.5f - 0.5f * path.knot[2 * i + 3]));
+	}
+
+	// Only the edited knot is uploaded.
+	const long knot = i / 2;
+
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, 4 * knot * sizeof(GLfloat), 4 * sizeof(GLfloat), path.knot + 4 * knot);
 }
 
+// Usage: composite_curve [pixel_error] [path file], see bezier_path_load for the file's format.
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
+	if (init_path(argc > 2 ? args[2] : NULL))
+		return 0;
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
+	profile_init();
+
+	if (init_buffers() || init_picker())
+		return 0;
 
 	glGenVertexArrays(2, VAO);
 
 	// Vertex attribute specification to use the OpenGL's inbuilt points and lines renders.
 	glBindVertexArray(VAO[0]);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
 	glEnableVertexAttribArray(0);
 
@@ -208,68 +411,102 @@ int main(int argc, char* args[])
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(1, 2, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), 2 * sizeof(GLfloat));
 	glEnableVertexAttribArray(1);
-
-	GLuint idx[] = { 
-		0,1,
-		1,2,
-		2,0
-	};
-
-	glGenBuffers(1, &IBO);
+	glBindBuffer(GL_ARRAY_BUFFER, ratio_buffer);
+	glVertexAttribPointer(2, 1, GL_FLOAT, GL_FALSE, 0, NULL);
+	glEnableVertexAttribArray(2);
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(idx), idx, GL_STATIC_DRAW);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 
 	glPointSize(6);
-	render();
 
 	SDL_Event e;
-	int vertex_selection = -1;
+	long vertex_selection = -1;
 	GLfloat offset[2];
 
-	while (SDL_WaitEvent(&e))
+	int streaming = 1;
+
+	for (;;)
 	{
-		if (e.type == SDL_QUIT)
+		// Stream a chunk per frame until the whole path is uploaded, then wait for input.
+		if (streaming)
+		{
+			streaming = stream_chunk();
+			render();
+
+			if (!SDL_PollEvent(&e))
+				continue;
+		}
+		else if (!SDL_WaitEvent(&e))
 			break;
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+		profile_cpu_start = SDL_GetPerformanceCounter();
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 6; i++)
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = 0;
+		long pending = -1;
+		int pending_x = 0, pending_y = 0;
+
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
+
+			// The drag's latest position is applied before the selection changes.
+			if ((e.type == SDL_MOUSEBUTTONUP || e.type == SDL_MOUSEBUTTONDOWN) && pending >= 0)
 			{
-				const GLint dx = SCREEN_WIDTH * (0.5f + 0.5f * control_point[2 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f - 0.5f * control_point[2 * i + 1]) - e.button.y;
+				move_point(pending, pending_x, pending_y, offset);
+				pending = -1;
+			}
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-				{
-					vertex_selection = i;
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
 
-					offset[0] = control_point[2 * i + 2] - control_point[2 * i];
-					offset[1] = control_point[2 * i + 3] - control_point[2 * i+1];
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+			{
+				const long i = bezier_picker_nearest(&picker, (float)e.button.x, (float)e.button.y, 3);
+
+				// Knots not uploaded yet aren't drawn.
+				vertex_selection = i < (long)(2 * uploaded_knots) ? i : -1;
+
+				if (vertex_selection >= 0 && i % 2 == 0)
+				{
+					offset[0] = path.knot[2 * i + 2] - path.knot[2 * i];
+					offset[1] = path.knot[2 * i + 3] - path.knot[2 * i + 1];
 				}
 			}
 
-		if (e.type == SDL_MOUSEMOTION)
-		{
-			if (vertex_selection < 0)
-				continue;
-
-			control_point[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_point[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
-			
-			// If moving P_0 point move the P_1 point.
-			if (vertex_selection % 2 == 0)
+			if (e.type == SDL_MOUSEMOTION)
 			{
-				control_point[2 * vertex_selection+2] = control_point[2 * vertex_selection] + offset[0];
-				control_point[2 * vertex_selection+3] = control_point[2 * vertex_selection+1] + offset[1];
+				if (vertex_selection < 0)
+					continue;
+
+				profile_event(e.motion.timestamp);
+
+				pending = vertex_selection;
+				pending_x = e.motion.x;
+				pending_y = e.motion.y;
+				moved = 1;
 			}
+		} while (SDL_PollEvent(&e));
+
+		if (pending >= 0)
+			move_point(pending, pending_x, pending_y, offset);
+
+		if (quit)
+			break;
 
-			glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
-		
+		// While streaming the next chunk draws anyway.
+		if (moved && !streaming)
 			render();
-		}
 	}
 
+	if (profile_log)
+		fclose(profile_log);
+
+	bezier_picker_free(&picker);
+	bezier_path_free(&path);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
@@ -11,17 +11,47 @@ struct pair_vertex
 };
 
 layout(location = 0) in pair_vertex[] vert_in;
+layout(location = 2) in float ratio_in[];
 
-vec2 control_points()
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// The line strip through n uniform samples of a cubic is within 3/4 max|P_i - 2P_{i+1} + P_{i+2}| / n^2 of the curve.
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float cubic_level(vec2 p0, vec2 p1, vec2 p2, vec2 p3)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	p0 *= scale;
+	p1 *= scale;
+	p2 *= scale;
+	p3 *= scale;
+
+	float flatness = max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+vec2 control_points(int i)
 {
-	switch(gl_InvocationID)
+	switch(i)
 	{
 		case 0:
 		return vert_in[0].p0;
 		case 1:
 		return vert_in[0].p1;
 		case 2:
-		return 2.0*vert_in[1].p0-vert_in[1].p1;
+		return vert_in[1].p0+ratio_in[1]*(vert_in[1].p0-vert_in[1].p1);
 		default:
 		return vert_in[1].p0;
 	}
@@ -32,8 +62,8 @@ void main(void)
 	if(gl_InvocationID == 0)
 	{
 		gl_TessLevelOuter[0] = 1.0;
-		gl_TessLevelOuter[1] = 128.0; 
+		gl_TessLevelOuter[1] = cubic_level(control_points(0), control_points(1), control_points(2), control_points(3));
 	}
 
-	gl_out[gl_InvocationID].gl_Position = vec4(control_points(),0,1);
+	gl_out[gl_InvocationID].gl_Position = vec4(control_points(gl_InvocationID),0,1);
 }
\ No newline at end of file
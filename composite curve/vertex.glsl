@@ -7,15 +7,20 @@
 layout(location = 0) in vec2 p0;
 layout(location = 1) in vec2 p1;
 
+// Length of the incoming handle relative to the outgoing one, 1 (velocity continuity) unless the path uploads them, see bezier_path.
+layout(location = 2) in float ratio;
+
 struct pair_vertex
 {
 	vec2 p0, p1;
 };
 
 layout(location = 0) out pair_vertex vert_out;
+layout(location = 2) out float ratio_out;
 
 void main()
 {
 	vert_out.p0 = p0;
 	vert_out.p1 = p1;
+	ratio_out = ratio;
 }
\ No newline at end of file
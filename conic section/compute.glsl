@@ -0,0 +1,117 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// Alternative to the tessellation shaders: evaluates every patch into a vertex buffer in one dispatch, an invocation per patch,
+// so the level isn't capped by GL_MAX_TESS_GEN_LEVEL. The lines' indices are appended for one glDrawElementsIndirect.
+#version 430
+layout(local_size_x = 64) in;
+
+// As the control shader's.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+uniform float level = 0.0;
+
+// Each patch has a slot of max_level + 1 vertices.
+uniform int max_level = 256;
+uniform int patches = 0;
+
+// Homogeneous (w*x, w*y, w), see vertex.glsl.
+layout(std430, binding = 1) readonly buffer control_points
+{
+	float control_point[];
+};
+
+// gl_Position then tessCoord, 6 floats a vertex as transform feedback captures the tessellation shaders' output.
+layout(std430, binding = 2) writeonly buffer vertices
+{
+	float vertex[];
+};
+
+layout(std430, binding = 3) writeonly buffer indices
+{
+	uint index[];
+};
+
+// glDrawElementsIndirect's command, the count is zeroed before each dispatch.
+layout(std430, binding = 4) buffer command
+{
+	uint index_count;
+	uint instance_count;
+	uint first_index;
+	int base_vertex;
+	uint base_instance;
+};
+
+vec4 point(uint p, int i)
+{
+	int j = (int(p) * 3 + i) * 3;
+
+	return vec4(control_point[j], control_point[j + 1], 0, control_point[j + 2]);
+}
+
+vec2 project(vec4 p)
+{
+	return p.xy / (p.w < 0.0 ? min(p.w, -1e-3) : max(p.w, 1e-3));
+}
+
+// The control shader's bound, capped by max_level instead.
+float conic_level(vec2 p0, vec2 p1, vec2 p2, float w)
+{
+	if (level > 0.0)
+		return clamp(ceil(level), 1.0, float(max_level));
+
+	vec2 scale = 0.5 * viewport;
+
+	p0 *= scale;
+	p1 *= scale;
+	p2 *= scale;
+
+	w = max(abs(w), 1e-3);
+
+	float flatness = max(w, 1.0 / w) * length(p0 - 2.0 * p1 + p2);
+	float polygon = length(p1 - p0) + length(p2 - p1);
+
+	float n = min(ceil(sqrt(0.25 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(max_level));
+}
+
+void main(void)
+{
+	uint p = gl_GlobalInvocationID.x;
+
+	if (p >= patches)
+		return;
+
+	vec4 q0 = point(p, 0), q1 = point(p, 1), q2 = point(p, 2);
+
+	int n = int(conic_level(project(q0), project(q1), project(q2), q1.w / sqrt(abs(q0.w * q2.w))));
+
+	uint first = p * (max_level + 1);
+
+	for (int k = 0; k <= n; k++)
+	{
+		float t = float(k) / n;
+
+		// Homogeneous, the division is left to the GL as for the evaluation shader.
+		vec4 a = mix(mix(q0, q1, t), mix(q1, q2, t), t);
+
+		uint v = 6 * (first + k);
+
+		vertex[v] = a.x;
+		vertex[v + 1] = a.y;
+		vertex[v + 2] = 0.0;
+		vertex[v + 3] = a.w;
+		vertex[v + 4] = t;
+		vertex[v + 5] = 0.0;
+	}
+
+	uint i = atomicAdd(index_count, uint(2 * n));
+
+	for (int k = 0; k < n; k++)
+	{
+		index[i + 2 * k] = first + k;
+		index[i + 2 * k + 1] = first + k + 1;
+	}
+}
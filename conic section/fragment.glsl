@@ -7,8 +7,6 @@
 layout(location = 0) in vec2 tessCoord;
 layout(location = 0) out vec4 diffuseColor;
 
-uniform float weight;
-
 void main()
 {
 	diffuseColor = vec4(tessCoord.x,0,1-tessCoord.x,1.0);
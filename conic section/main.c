@@ -4,19 +4,30 @@
 
 #include <SDL.h>
 #include <gl/glew.h>
+#include "../bezier/bezier.h"
 #include <stdio.h>
+#include <string.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT SCREEN_WIDTH
 
 SDL_Window* window = NULL;
 
+// The control points drawn over the conics.
 GLuint VAO = 0;
 GLuint VBO = 0;
-GLuint IBO = 0;
+
+GLuint patch_VAO = 0;
+GLuint patch_buffer = 0;
 
 GLuint program = 0;
 
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
+// The first conic's specification, see bezier_conic_sections, followed by w B once it's solved.
 GLfloat control_point[12] = {
 	-0.3,0.0, //P_0
 	 0.0,0.3, //P_1
@@ -26,7 +37,30 @@ GLfloat control_point[12] = {
 	 0.0,0.5  //B
 };
 
-GLfloat weight = 0.75;
+// Every conic's specification and the patch drawn for it, the first is the one edited and the rest can be loaded from a file.
+size_t conic_count = 1;
+float* specification = NULL;
+float* patch = NULL;
+int* degenerate = NULL;
+
+// The conics are solved on a worker stage while the previous frame draws, see bezier_stage in bezier/bezier.h.
+// Loaded conics are solved in one batch split between the threads. Edits solve a copy of the first conic's specification,
+// two alternating so an edit can be submitted while the last is still in flight.
+struct solve
+{
+	struct bezier_batch batch;
+	float specification[10];
+	float patch[9];
+	int degenerate;
+	int submitted;
+};
+
+struct bezier_stage* stage = NULL;
+struct bezier_batch load = { 0 };
+struct solve solves[2];
+Uint32 solved_event = 0;
+
+int threads = 1;
 
 int init_sdl()
 {
@@ -131,16 +165,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (
-		attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
 		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
-		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER))
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -160,8 +198,14 @@ int init_program()
 		return 1;
 	}
 
+	cache_save(program);
+
 	glPatchParameteri(GL_PATCH_VERTICES, 3);
 
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+
 	return 0;
 }
 
@@ -169,78 +213,203 @@ void render()
 {
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	glBindVertexArray(patch_VAO);
 	glUseProgram(program);
-	glDrawElements(GL_PATCHES, 3, GL_UNSIGNED_INT, NULL);
+	profile_begin(0);
+	glDrawArrays(GL_PATCHES, 0, (GLsizei)(3 * conic_count));
+	profile_end(0);
 
+	glBindVertexArray(VAO);
 	glUseProgram(0);
+	profile_begin(1);
 	glDrawArrays(GL_POINTS, 0, 6);
+	profile_end(1);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
 }
 
-static GLfloat signed_area(size_t i, size_t j, size_t z)
+void solve_loaded(struct bezier_batch* batch, size_t begin, size_t end)
 {
-	return control_point[2 * i] * control_point[2 * j + 1]
-		- control_point[2 * j] * control_point[2 * i + 1]
-		+ control_point[2 * z] * control_point[2 * i + 1]
-		- control_point[2 * i] * control_point[2 * z + 1]
-		+ control_point[2 * j] * control_point[2 * z + 1]
-		- control_point[2 * z] * control_point[2 * j + 1];
+	(void)batch;
+
+	bezier_conic_sections(end - begin, specification + 10 * begin, patch + 9 * begin, degenerate + begin);
 }
 
-void geometry()
+void solve_edit(struct bezier_batch* batch, size_t begin, size_t end)
 {
-	// Get intersection
-	const GLfloat l0 = control_point[7] - control_point[1];
-	const GLfloat l1 = control_point[0] - control_point[6];
-	const GLfloat l2 = control_point[7] * control_point[0] - control_point[6] * control_point[1];
+	struct solve* solve = batch->context;
 
-	const GLfloat l3 = control_point[9] - control_point[5];
-	const GLfloat l4 = control_point[4] - control_point[8];
-	const GLfloat l5 = control_point[9] * control_point[4] - control_point[8] * control_point[5];
+	(void)begin;
+	(void)end;
 
-	GLfloat d = l0 * l4 - l1 * l3;
+	bezier_conic_sections(1, solve->specification, solve->patch, &solve->degenerate);
+}
 
-	if (d == 0)
+// Wakes the event loop, called on the stage's leader.
+void solve_finished(void* context)
+{
+	(void)context;
+
+	SDL_PushEvent(&(SDL_Event){ .type = solved_event });
+}
+
+// Returns non-zero if both solves are in flight.
+int submit_solve()
+{
+	for (int i = 0; i < 2; i++)
 	{
-		// TODO: handle parallel case
+		struct solve* solve = &solves[i];
+
+		if (solve->submitted)
+			continue;
+
+		memcpy(solve->specification, control_point, sizeof(solve->specification));
+		solve->batch = (struct bezier_batch){ .function = solve_edit, .count = 1, .grain = 1, .finished = solve_finished, .context = solve };
+		solve->submitted = !bezier_stage_submit(stage, &solve->batch);
+
+		return !solve->submitted;
+	}
+
+	return 1;
+}
+
+// Writes only the floats of a conic's patch that changed, e.g. moving P_1 or a tangent only changes the middle point.
+void update_patch(size_t conic, const float* solved)
+{
+	float* drawn = patch + 9 * conic;
+	int first = 0, last = 8;
+
+	while (first < 9 && drawn[first] == solved[first])
+		first++;
+
+	if (first == 9)
 		return;
+
+	while (drawn[last] == solved[last])
+		last--;
+
+	memcpy(drawn + first, solved + first, (last - first + 1) * sizeof(float));
+
+	glBindBuffer(GL_ARRAY_BUFFER, patch_buffer);
+	glBufferSubData(GL_ARRAY_BUFFER, (9 * conic + first) * sizeof(float), (last - first + 1) * sizeof(float), drawn + first);
+}
+
+// Uploads the finished solves, returns non-zero if there were any.
+// A degenerate edit (see bezier_conic_sections) keeps the last conic drawn rather than its chord.
+int take_solves()
+{
+	struct bezier_batch* batch;
+	struct solve* newest = NULL;
+	int taken = 0;
+
+	while ((batch = bezier_stage_take(stage)))
+	{
+		taken = 1;
+
+		if (batch == &load)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, patch_buffer);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, 9 * conic_count * sizeof(float), patch);
+
+			control_point[10] = patch[3];
+			control_point[11] = patch[4];
+
+			continue;
+		}
+
+		newest = batch->context;
+		newest->submitted = 0;
 	}
 
-	d = 1.0 / d;
+	if (newest && !newest->degenerate)
+	{
+		update_patch(0, newest->patch);
 
-	control_point[10] = d * (l2 * l4 - l1 * l5);
-	control_point[11] = d * (l0 * l5 - l2 * l3);
+		control_point[10] = patch[3];
+		control_point[11] = patch[4];
+	}
 
-	// Calculate area-coordinates
-	const GLfloat b0 = signed_area(1, 5, 2);
-	const GLfloat b1 = signed_area(0, 1, 2);
-	const GLfloat b2 = signed_area(0, 5, 1);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferSubData(GL_ARRAY_BUFFER, 10 * sizeof(GLfloat), 2 * sizeof(GLfloat), control_point + 10);
 
-	// Calculate weight and control point
-	weight = 0.5 * b1 / sqrtf(b0 * b2);
+	return taken;
+}
 
-	if (signed_area(0, 5, 2) < 0)
-		weight *= -1;
+// The first conic's specification then any in the file, a line "x0 y0 x1 y1 x2 y2 tx0 ty0 tx2 ty2" each (P_0, P_1, P_2, T_0, T_2).
+int init_conics(const char* file)
+{
+	size_t capacity = 1;
+	specification = malloc(10 * sizeof(float));
 
-	control_point[10] *= weight;
-	control_point[11] *= weight;
+	if (!specification)
+		return 1;
 
-	// Pass to shader
-	glUseProgram(program);
-	GLint uniform_location = glGetUniformLocation(program, "weight");
-	glUniform1f(uniform_location, weight);
-	glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
+	memcpy(specification, control_point, 10 * sizeof(float));
+
+	if (file)
+	{
+		FILE* stream;
+		fopen_s(&stream, file, "r");
+
+		if (!stream)
+		{
+			printf("Unable to read: %s\n", file);
+			return 1;
+		}
+
+		float s[10];
+
+		while (fscanf(stream, "%f %f %f %f %f %f %f %f %f %f", &s[0], &s[1], &s[2], &s[3], &s[4], &s[5], &s[6], &s[7], &s[8], &s[9]) == 10)
+		{
+			if (conic_count == capacity)
+			{
+				float* grown = realloc(specification, 20 * capacity * sizeof(float));
+
+				if (!grown)
+				{
+					fclose(stream);
+					return 1;
+				}
+
+				specification = grown;
+				capacity *= 2;
+			}
+
+			memcpy(specification + 10 * conic_count++, s, sizeof(s));
+		}
+
+		fclose(stream);
+	}
+
+	patch = calloc(9 * conic_count, sizeof(float));
+	degenerate = calloc(conic_count, sizeof(int));
+
+	return !patch || !degenerate;
 }
 
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
+	if (argc > 2)
+		threads = atoi(args[2]);
+
+	if (init_conics(argc > 3 ? args[3] : NULL))
+	{
+		printf("Unable to load the conics\n");
+		return 0;
+	}
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
+	profile_init();
+
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
 	glEnableVertexAttribArray(0);
@@ -248,52 +417,117 @@ int main(int argc, char* args[])
 	glGenBuffers(1, &VBO);
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-	glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
-	
-	glGenBuffers(1, &IBO);
-	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
-	glBufferData(GL_ELEMENT_ARRAY_BUFFER,
-		3*sizeof(GLuint),
-		(GLuint[3]){0,5,2}, GL_STATIC_DRAW);
+	glBufferData(GL_ARRAY_BUFFER, 12 * sizeof(GLfloat), control_point, GL_DYNAMIC_DRAW);
+
+	// Patches are drawn straight from bezier_conic_sections' output, homogeneous points (w x, w y, w) with the weight
+	// in the vertex stream, so every conic is drawn in one call whatever its weight.
+	glGenVertexArrays(1, &patch_VAO);
+	glBindVertexArray(patch_VAO);
+
+	glGenBuffers(1, &patch_buffer);
+	glBindBuffer(GL_ARRAY_BUFFER, patch_buffer);
+	glBufferData(GL_ARRAY_BUFFER, 9 * conic_count * sizeof(float), patch, GL_DYNAMIC_DRAW);
+
+	glEnableVertexAttribArray(0);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 3 * sizeof(float), NULL);
+
+	glEnableVertexAttribArray(1);
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)(2 * sizeof(float)));
 
 	glPointSize(6);
-	geometry();
+
+	stage = bezier_stage_create(threads, 2);
+	solved_event = SDL_RegisterEvents(1);
+
+	if (!stage || solved_event == (Uint32)-1)
+	{
+		printf("Unable to start the solve stage\n");
+		return 0;
+	}
+
+	// The conics are drawn once they're solved.
+	load = (struct bezier_batch){ .function = solve_loaded, .count = conic_count, .grain = 4096, .finished = solve_finished };
+	bezier_stage_submit(stage, &load);
+
 	render();
 
 	SDL_Event e;
 	int vertex_selection = -1;
+	int stale = 0;
 
 	while (SDL_WaitEvent(&e))
 	{
-		if (e.type == SDL_QUIT)
-			break;
+		profile_cpu_start = SDL_GetPerformanceCounter();
+
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = 0;
+		int solved = 0;
+
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+			if (e.type == solved_event)
+				solved = 1;
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 5; i++)
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
+
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+				for (int i = 0; i < 5; i++)
+				{
+					const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_point[2 * i]) - e.button.x;
+					const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_point[2 * i + 1]) - e.button.y;
+
+					if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
+						vertex_selection = i;
+				}
+
+			if (e.type == SDL_MOUSEMOTION)
 			{
-				const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_point[2 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_point[2 * i + 1]) - e.button.y;
+				if (vertex_selection < 0)
+					continue;
+
+				profile_event(e.motion.timestamp);
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-					vertex_selection = i;
+				control_point[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
+				control_point[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+
+				moved = 1;
 			}
+		} while (SDL_PollEvent(&e));
+
+		if (quit)
+			break;
 
-		if (e.type == SDL_MOUSEMOTION)
+		// The points are drawn where they were moved to straight away, the conic through them once it's solved.
+		// An edit made while both solves are in flight is submitted when one returns.
+		if (moved)
 		{
-			if (vertex_selection < 0)
-				continue;
+			stale = submit_solve();
 
-			control_point[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_point[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+			glBindBuffer(GL_ARRAY_BUFFER, VBO);
+			glBufferSubData(GL_ARRAY_BUFFER, 0, 10 * sizeof(GLfloat), control_point);
+		}
+
+		if (solved && take_solves() && stale)
+			stale = submit_solve();
 
-			geometry();
+		if (moved || solved)
 			render();
-		}
 	}
 
+	bezier_stage_destroy(stage);
+
+	free(specification);
+	free(patch);
+	free(degenerate);
+
+	if (profile_log)
+		fclose(profile_log);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
@@ -1,22 +1,62 @@
-// Copyright 2024 Kieran W Harvie. All rights reserved.
+// Copyright 2024-2025 Kieran W Harvie. All rights reserved.
 // Use of this source code is governed by an MIT-style
 // license that can be found in the LICENSE file.
 
 #version 430
 layout (vertices = 3) out;
 
-uniform float weight;
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// The line strip through n uniform samples of a quadratic is within 1/4 |P_0 - 2P_1 + P_2| / n^2 of the curve.
+// A weight away from one bunches the samples towards one end, which is allowed for by scaling the bound by max(w, 1/w).
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float conic_level(vec2 p0, vec2 p1, vec2 p2, float w)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	p0 *= scale;
+	p1 *= scale;
+	p2 *= scale;
+
+	// Parallel tangents give w = 0 with P_1 at infinity, which the most segments are used for.
+	w = max(abs(w), 1e-3);
+
+	float flatness = max(w, 1.0 / w) * length(p0 - 2.0 * p1 + p2);
+	float polygon = length(p1 - p0) + length(p2 - p1);
+
+	float n = min(ceil(sqrt(0.25 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+// The point a homogeneous control point stands for, with parallel tangents' zero weight taken as a small one.
+vec2 project(vec4 p)
+{
+	return p.xy / (p.w < 0.0 ? min(p.w, -1e-3) : max(p.w, 1e-3));
+}
 
 void main(void)
 {
 	if(gl_InvocationID == 0)
 	{
+		// The middle weight in the standard form with the endpoints' one, which bezier_conic_sections already writes.
+		float w = gl_in[1].gl_Position.w / sqrt(abs(gl_in[0].gl_Position.w * gl_in[2].gl_Position.w));
+
 		gl_TessLevelOuter[0] = 1.0;
-		gl_TessLevelOuter[1] = 128.0; 
+		gl_TessLevelOuter[1] = conic_level(
+			project(gl_in[0].gl_Position),
+			project(gl_in[1].gl_Position),
+			project(gl_in[2].gl_Position),
+			w);
 	}
 
-	if(gl_InvocationID == 1)
-		gl_out[gl_InvocationID].gl_Position = vec4(gl_in[gl_InvocationID].gl_Position.xyz,weight);
-	else
-		gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+	gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
 }
\ No newline at end of file
@@ -6,7 +6,10 @@
 
 layout(location = 0) in vec2 position;
 
+// Homogeneous points (w*x, w*y) with their weight w here, see main.c.
+layout(location = 1) in float weight;
+
 void main()
 {
-	gl_Position = vec4( position, 0, 1 );
+	gl_Position = vec4( position, 0, weight );
 }
\ No newline at end of file
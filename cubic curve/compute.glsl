@@ -0,0 +1,122 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// Alternative to the tessellation shaders: evaluates every patch into a vertex buffer in one dispatch, an invocation per patch,
+// so the level isn't capped by GL_MAX_TESS_GEN_LEVEL. The lines' indices are appended for one glDrawElementsIndirect.
+#version 430
+layout(local_size_x = 64) in;
+
+// As the control shader's.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+uniform float level = 0.0;
+
+// Each patch has a slot of max_level + 1 vertices.
+uniform int max_level = 256;
+uniform int patches = 0;
+
+// Floats per control point, 2 for (x, y) or 3 for homogeneous (w*x, w*y, w).
+uniform int stride = 2;
+
+layout(std430, binding = 1) readonly buffer control_points
+{
+	float control_point[];
+};
+
+// gl_Position then tessCoord, 6 floats a vertex as transform feedback captures the tessellation shaders' output.
+layout(std430, binding = 2) writeonly buffer vertices
+{
+	float vertex[];
+};
+
+layout(std430, binding = 3) writeonly buffer indices
+{
+	uint index[];
+};
+
+// glDrawElementsIndirect's command, the count is zeroed before each dispatch.
+layout(std430, binding = 4) buffer command
+{
+	uint index_count;
+	uint instance_count;
+	uint first_index;
+	int base_vertex;
+	uint base_instance;
+};
+
+vec4 point(uint p, int i)
+{
+	int j = (int(p) * 4 + i) * stride;
+
+	return vec4(control_point[j], control_point[j + 1], 0, stride == 3 ? control_point[j + 2] : 1.0);
+}
+
+// The control shader's bound, capped by max_level instead.
+float cubic_level(vec4 q0, vec4 q1, vec4 q2, vec4 q3)
+{
+	if (level > 0.0)
+		return clamp(ceil(level), 1.0, float(max_level));
+
+	vec2 scale = 0.5 * viewport;
+
+	vec2 p0 = scale * q0.xy / q0.w;
+	vec2 p1 = scale * q1.xy / q1.w;
+	vec2 p2 = scale * q2.xy / q2.w;
+	vec2 p3 = scale * q3.xy / q3.w;
+
+	float ratio = max(max(q0.w, q1.w), max(q2.w, q3.w)) / min(min(q0.w, q1.w), min(q2.w, q3.w));
+
+	float flatness = ratio * max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(max_level));
+}
+
+void main(void)
+{
+	uint p = gl_GlobalInvocationID.x;
+
+	if (p >= patches)
+		return;
+
+	vec3 q[4];
+
+	for (int i = 0; i < 4; i++)
+		q[i] = point(p, i).xyw;
+
+	int n = int(cubic_level(point(p, 0), point(p, 1), point(p, 2), point(p, 3)));
+
+	uint first = p * (max_level + 1);
+
+	for (int k = 0; k <= n; k++)
+	{
+		float t = float(k) / n;
+
+		// Homogeneous, the division is left to the GL as for the evaluation shader.
+		vec3 a[4] = q;
+
+		for (int i = 3; i >= 0; i--)
+		for (int j = 0; j < i; j++)
+			a[j] = mix(a[j], a[j + 1], t);
+
+		uint v = 6 * (first + k);
+
+		vertex[v] = a[0].x;
+		vertex[v + 1] = a[0].y;
+		vertex[v + 2] = 0.0;
+		vertex[v + 3] = a[0].z;
+		vertex[v + 4] = t;
+		vertex[v + 5] = 0.0;
+	}
+
+	uint i = atomicAdd(index_count, uint(2 * n));
+
+	for (int k = 0; k < n; k++)
+	{
+		index[i + 2 * k] = first + k;
+		index[i + 2 * k + 1] = first + k + 1;
+	}
+}
@@ -4,7 +4,11 @@
 
 #include <SDL.h>
 #include <gl/glew.h>
+#include "../bezier/bezier.h"
 #include <stdio.h>
+#include <string.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT SCREEN_WIDTH
@@ -17,6 +21,23 @@ GLuint IBO = 0;
 
 GLuint program = 0;
 
+// Index of the control points in pixels for picking, build with ../bezier/picking.c.
+struct bezier_picker picker;
+
+// Control points are streamed through a persistently mapped buffer holding RING_SIZE copies of them.
+// Each frame writes the copy drawn longest ago, first waiting on its fence in case the GPU is still reading it,
+// and only copies the range of floats changed since that copy was last written.
+#define RING_SIZE 3
+
+GLfloat* mapped = NULL;
+GLsync fence[RING_SIZE] = { 0 };
+int ring_index = 0;
+size_t dirty_low[RING_SIZE];
+size_t dirty_high[RING_SIZE];
+
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
 GLfloat control_point[8] = {
 	-0.5, 0.0, 
 	-0.2, 0.4, 
@@ -24,11 +45,20 @@ GLfloat control_point[8] = {
 	 0.5, 0.0, 
 };
 
+// Copies of the curve are laid out in a grid, all in one buffer and drawn with a single call.
+int curve_count = 1;
+GLfloat* control_points = NULL;
+
+// When set the curves are sampled at equal steps of arc length, looked up in a table per curve, see tessellation_control.glsl.
+int arc_length = 0;
+GLuint arc_length_buffer = 0;
+GLfloat* arc_length_tables = NULL;
+
 int init_sdl()
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 || 
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 4) < 0 ||
-		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,3) < 0 ||
+		SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION,4) < 0 ||
 		SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_CORE) < 0)
 	{
 		fprintf(stderr, "could not initialize sdl2: %s\n", SDL_GetError());
@@ -127,14 +157,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
-		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER))
+		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -154,8 +190,108 @@ int init_program()
 		return 1;
 	}
 
+	cache_save(program);
+
 	glPatchParameteri(GL_PATCH_VERTICES, 4);
-	glPatchParameterfv(GL_PATCH_DEFAULT_OUTER_LEVEL, (GLfloat[2]){ 1.0,128.0 });
+
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+
+	return 0;
+}
+
+void mark_dirty(size_t low, size_t high)
+{
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		dirty_low[i] = low < dirty_low[i] ? low : dirty_low[i];
+		dirty_high[i] = high > dirty_high[i] ? high : dirty_high[i];
+	}
+}
+
+int init_ring()
+{
+	const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	const GLsizeiptr size = RING_SIZE * (8 * curve_count) * sizeof(GLfloat);
+
+	glGenBuffers(1, &VBO);
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glBufferStorage(GL_ARRAY_BUFFER, size, NULL, flags);
+
+	mapped = glMapBufferRange(GL_ARRAY_BUFFER, 0, size, flags);
+
+	if (!mapped)
+	{
+		printf("Unable to map the control point buffer\n");
+		return 1;
+	}
+
+	for (int i = 0; i < RING_SIZE; i++)
+	{
+		dirty_low[i] = 0;
+		dirty_high[i] = (8 * curve_count);
+	}
+
+	return 0;
+}
+
+// Writes the changed control points to the next copy, returns the copy's first vertex.
+GLint upload()
+{
+	ring_index = (ring_index + 1) % RING_SIZE;
+
+	if (fence[ring_index])
+	{
+		while (glClientWaitSync(fence[ring_index], GL_SYNC_FLUSH_COMMANDS_BIT, 1000000) == GL_TIMEOUT_EXPIRED);
+
+		glDeleteSync(fence[ring_index]);
+		fence[ring_index] = 0;
+	}
+
+	if (dirty_low[ring_index] < dirty_high[ring_index])
+		memcpy(mapped + ring_index * (8 * curve_count) + dirty_low[ring_index], control_points + dirty_low[ring_index],
+			(dirty_high[ring_index] - dirty_low[ring_index]) * sizeof(GLfloat));
+
+	dirty_low[ring_index] = (8 * curve_count);
+	dirty_high[ring_index] = 0;
+
+	return ring_index * ((8 * curve_count) / 2);
+}
+
+// Recomputes the tables of curves [low, high) and writes them to the buffer.
+void update_arc_length(int low, int high)
+{
+	if (!arc_length)
+		return;
+
+	bezier_arc_length_tables(BEZIER_PATCH_CUBIC_CURVE, high - low, control_points + 8 * low, arc_length_tables + BEZIER_ARC_LENGTH_FLOATS * low);
+
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, arc_length_buffer);
+	glBufferSubData(GL_SHADER_STORAGE_BUFFER, BEZIER_ARC_LENGTH_FLOATS * low * sizeof(GLfloat), BEZIER_ARC_LENGTH_FLOATS * (high - low) * sizeof(GLfloat),
+		arc_length_tables + BEZIER_ARC_LENGTH_FLOATS * low);
+}
+
+int init_arc_length()
+{
+	if (!arc_length)
+		return 0;
+
+	arc_length_tables = malloc(BEZIER_ARC_LENGTH_FLOATS * curve_count * sizeof(GLfloat));
+
+	if (!arc_length_tables)
+	{
+		printf("Unable to allocate the arc length tables\n");
+		return 1;
+	}
+
+	glGenBuffers(1, &arc_length_buffer);
+	glBindBuffer(GL_SHADER_STORAGE_BUFFER, arc_length_buffer);
+	glBufferData(GL_SHADER_STORAGE_BUFFER, BEZIER_ARC_LENGTH_FLOATS * curve_count * sizeof(GLfloat), NULL, GL_DYNAMIC_DRAW);
+	glBindBufferBase(GL_SHADER_STORAGE_BUFFER, 0, arc_length_buffer);
+
+	glUniform1i(glGetUniformLocation(program, "arc_length"), 1);
+	update_arc_length(0, curve_count);
 
 	return 0;
 }
@@ -164,31 +300,110 @@ void render()
 {
 	glClear(GL_COLOR_BUFFER_BIT);
 
+	const GLint first = upload();
+
 	glUseProgram(program);
-	glDrawArrays(GL_PATCHES, 0, 4);
+	glUniform1i(glGetUniformLocation(program, "first_patch"), first / 4);
+	profile_begin(0);
+	glDrawArrays(GL_PATCHES, first, 4 * curve_count);
+	profile_end(0);
 
 	glUseProgram(0);
-	glDrawArrays(GL_POINTS, 0, 4);
+	profile_begin(1);
+	glDrawArrays(GL_POINTS, first, 4 * curve_count);
+	profile_end(1);
+
+	fence[ring_index] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
+}
+
+// Moves control point i to the pixel (x, y), the drain loop calls it once a frame with the drag's latest position.
+void move_point(int i, int x, int y)
+{
+	control_points[2 * i] = 2.0f * ((float)x) / ((float)SCREEN_WIDTH) - 1.0f;
+	control_points[2 * i + 1] = 1.0f - 2.0f * ((float)y) / ((float)SCREEN_HEIGHT);
+
+	bezier_picker_move(&picker, i, (float)x, (float)y);
+
+	mark_dirty(2 * i, 2 * i + 2);
+	update_arc_length(i / 4, i / 4 + 1);
 }
 
+// Usage: cubic_curve [pixel_error] [curve count] [arc length, non-zero to sample at equal steps of arc length]
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
+	if (argc > 2 && atoi(args[2]) > 0)
+		curve_count = atoi(args[2]);
+
+	if (argc > 3)
+		arc_length = atoi(args[3]) != 0;
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
+	profile_init();
+
+	control_points = malloc(8 * curve_count * sizeof(GLfloat));
+
+	if (!control_points)
+	{
+		printf("Unable to allocate %d curves\n", curve_count);
+		return 0;
+	}
+
+	int side = 1;
+
+	while (side * side < curve_count)
+		side++;
+
+	for (int c = 0; c < curve_count; c++)
+		for (int i = 0; i < 4; i++)
+		{
+			control_points[8 * c + 2 * i] = (control_point[2 * i] + 2 * (c % side) + 1) / side - 1.0f;
+			control_points[8 * c + 2 * i + 1] = (control_point[2 * i + 1] + 2 * (c / side) + 1) / side - 1.0f;
+		}
+
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
 	glEnableVertexAttribArray(0);
+	// The patches are polynomial, see the vertex shader.
+	glVertexAttrib1f(1, 1.0f);
+
+	if (init_ring())
+		return 0;
 
-	glGenBuffers(1, &VBO);
-	glBindBuffer(GL_ARRAY_BUFFER, VBO);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
-	glBufferData(GL_ARRAY_BUFFER, 8* sizeof(GLfloat), control_point, GL_STATIC_DRAW);
+
+	GLfloat* pixels = malloc(2 * 4 * curve_count * sizeof(GLfloat));
+
+	if (!pixels)
+		return 0;
+
+	for (int i = 0; i < 4 * curve_count; i++)
+	{
+		pixels[2 * i] = SCREEN_WIDTH * (0.5f + 0.5f * control_points[2 * i]);
+		pixels[2 * i + 1] = SCREEN_HEIGHT * (0.5f - 0.5f * control_points[2 * i + 1]);
+	}
+
+	const int picker_failed = bezier_picker_init(&picker, 4 * curve_count, pixels, (float[2]) { 0, 0 }, (float[2]) { SCREEN_WIDTH, SCREEN_HEIGHT }, 8);
+	free(pixels);
+
+	if (picker_failed)
+	{
+		printf("Unable to allocate the picker\n");
+		return 0;
+	}
+
+	if (init_arc_length())
+		return 0;
 	
 	glPointSize(6);
 	render();
@@ -198,36 +413,64 @@ int main(int argc, char* args[])
 
 	while (SDL_WaitEvent(&e))
 	{
-		if (e.type == SDL_QUIT)
-			break;
+		profile_cpu_start = SDL_GetPerformanceCounter();
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = 0;
+		int pending = -1, pending_x = 0, pending_y = 0;
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 4; i++)
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
+
+			// The drag's latest position is applied before the selection changes.
+			if ((e.type == SDL_MOUSEBUTTONUP || e.type == SDL_MOUSEBUTTONDOWN) && pending >= 0)
+			{
+				move_point(pending, pending_x, pending_y);
+				pending = -1;
+			}
+
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
+
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+				vertex_selection = (int)bezier_picker_nearest(&picker, (float)e.button.x, (float)e.button.y, 3);
+
+			if (e.type == SDL_MOUSEMOTION)
 			{
-				const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_point[2 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_point[2 * i + 1]) - e.button.y;
+				if (vertex_selection < 0)
+					continue;
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-					vertex_selection = i;
+				profile_event(e.motion.timestamp);
+
+				pending = vertex_selection;
+				pending_x = e.motion.x;
+				pending_y = e.motion.y;
+				moved = 1;
 			}
+		} while (SDL_PollEvent(&e));
 
-		if (e.type == SDL_MOUSEMOTION)
-		{
-			if (vertex_selection < 0)
-				continue;
+		if (pending >= 0)
+			move_point(pending, pending_x, pending_y);
 
-			control_point[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_point[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+		if (quit)
+			break;
 
-			glBufferData(GL_ARRAY_BUFFER, 8 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
-		
+		if (moved)
+		{
 			render();
 		}
 	}
 
+	bezier_picker_free(&picker);
+	free(control_points);
+	free(arc_length_tables);
+
+	if (profile_log)
+		fclose(profile_log);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
@@ -0,0 +1,112 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#version 430
+layout (vertices = 4) out;
+
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// When set the control shader converts the control points to power basis coefficients once per patch
+// and the evaluation shader sums them with Horner's rule, 3 multiply-adds per coordinate instead of de Casteljau's 6 mixes.
+// Unlike de Casteljau it isn't exact at t = 1, so curves sharing an end point may not quite meet.
+uniform bool power_basis = false;
+
+// When set the evaluation shader samples the curve at equal steps of arc length, looking the parameters up in the patch's table
+// (see bezier_arc_length_tables), so the samples don't bunch up where the curve is slow and fewer are needed.
+// Patch i's table is the (i - first_patch)th, i counting the patches from the buffer's start as gl_VertexID does.
+uniform bool arc_length = false;
+uniform int first_patch = 0;
+
+#define ARC_LENGTH_SAMPLES 16
+#define ARC_LENGTH_FLOATS (ARC_LENGTH_SAMPLES + 3)
+
+layout(std430, binding = 0) readonly buffer arc_length_tables
+{
+	float arc_length_table[];
+};
+
+layout(location = 0) in int vertex_id[];
+
+// Offset of the patch's table for the evaluation shader.
+patch out int table;
+
+// Row i holds the Bernstein points' contributions to the coefficient of t^i.
+const float bernstein_to_power[16] = float[16](
+	 1, 0, 0, 0,
+	-3, 3, 0, 0,
+	 3,-6, 3, 0,
+	-1, 3,-3, 1);
+
+// The line strip through n uniform samples of a cubic is within 3/4 max|P_i - 2P_{i+1} + P_{i+2}| / n^2 of the curve.
+// Rational curves are measured on their projected points, their weights bunch the samples up by at most the ratio w_max / w_min
+// which is allowed for by scaling the bound by it, as 'conic section' does with max(w, 1/w).
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float cubic_level(vec4 q0, vec4 q1, vec4 q2, vec4 q3)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	vec2 p0 = scale * q0.xy / q0.w;
+	vec2 p1 = scale * q1.xy / q1.w;
+	vec2 p2 = scale * q2.xy / q2.w;
+	vec2 p3 = scale * q3.xy / q3.w;
+
+	float ratio = max(max(q0.w, q1.w), max(q2.w, q3.w)) / min(min(q0.w, q1.w), min(q2.w, q3.w));
+
+	float flatness = ratio * max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+// Chords of equal length h along a curve are within k h^2 / 8 of it, k being its largest curvature, so n = L sqrt(k / 8e) are enough.
+float arc_length_level()
+{
+	if (level > 0.0)
+		return level;
+
+	float scale = 0.5 * max(viewport.x, viewport.y);
+	float length = scale * arc_length_table[table];
+	float curvature = arc_length_table[table + 1] / scale;
+
+	float n = min(ceil(length * sqrt(curvature / (8.0 * pixel_error))), ceil(length));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+void main(void)
+{
+	if(gl_InvocationID == 0)
+	{
+		table = (vertex_id[0] / 4 - first_patch) * ARC_LENGTH_FLOATS;
+
+		gl_TessLevelOuter[0] = 1.0;
+		gl_TessLevelOuter[1] = arc_length ? arc_length_level() : cubic_level(
+			gl_in[0].gl_Position,
+			gl_in[1].gl_Position,
+			gl_in[2].gl_Position,
+			gl_in[3].gl_Position);
+	}
+
+	if (power_basis)
+	{
+		vec4 c = vec4(0.0);
+
+		for (int j = 0; j < 4; j++)
+			c += bernstein_to_power[4 * gl_InvocationID + j] * gl_in[j].gl_Position;
+
+		gl_out[gl_InvocationID].gl_Position = c;
+	}
+	else
+		gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+}
\ No newline at end of file
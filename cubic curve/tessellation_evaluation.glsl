@@ -6,18 +6,54 @@
 layout(isolines) in;
 layout (location = 0) out vec2 tessCoord;
 
+// See the control shader.
+uniform bool power_basis = false;
+uniform bool arc_length = false;
+
+#define ARC_LENGTH_SAMPLES 16
+
+layout(std430, binding = 0) readonly buffer arc_length_tables
+{
+	float arc_length_table[];
+};
+
+patch in int table;
+
 void main(void)
 {
-	tessCoord = gl_TessCoord.xy;
+	// The table's parameters are at equal fractions of the length, gl_TessCoord.x is interpolated between them.
+	float t = gl_TessCoord.x;
+
+	if (arc_length)
+	{
+		float f = t * ARC_LENGTH_SAMPLES;
+		int i = min(int(f), ARC_LENGTH_SAMPLES - 1);
+
+		t = mix(arc_length_table[table + 2 + i], arc_length_table[table + 3 + i], f - i);
+	}
+
+	tessCoord = vec2(t, gl_TessCoord.y);
+
+	if (power_basis)
+	{
+		vec3 c = gl_in[3].gl_Position.xyw;
+
+		for (int i = 2; i >= 0; i--)
+			c = c * t + gl_in[i].gl_Position.xyw;
+
+		gl_Position = vec4(c.xy,0,c.z);
+		return;
+	}
 
-	vec2 a[4];
+	// Homogeneous (w*x, w*y, w), the division is left to the GL as for 'conic section'.
+	vec3 a[4];
 
 	for(int i = 0; i < 4; i++)
-		a[i] = gl_in[i].gl_Position.xy;
+		a[i] = gl_in[i].gl_Position.xyw;
 
 	for(int i = 3; i >= 0; i--)
 	for(int j = 0; j < i; j++)
-		a[j] = mix(a[j],a[j+1],gl_TessCoord.x);
+		a[j] = mix(a[j],a[j+1],t);
 
-	gl_Position = vec4(a[0],0,1);
+	gl_Position = vec4(a[0].xy,0,a[0].z);
 }
\ No newline at end of file
@@ -6,7 +6,15 @@
 
 layout(location = 0) in vec2 position;
 
+// Rational patches upload homogeneous points (w*x, w*y) with their weight w here,
+// polynomial ones leave the array disabled and set its current value to 1.
+layout(location = 1) in float weight;
+
+// Finds the patch's arc length table, see the control shader.
+layout(location = 0) out int vertex_id;
+
 void main()
 {
-	gl_Position = vec4( position, 0, 1 );
+	gl_Position = vec4( position, 0, weight );
+	vertex_id = gl_VertexID;
 }
\ No newline at end of file
@@ -5,6 +5,8 @@
 #include <SDL.h>
 #include <gl/glew.h>
 #include <stdio.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT 480
@@ -16,6 +18,9 @@ GLuint VBO = 0;
 
 GLuint program = 0;
 
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
 int init_sdl()
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 || 
@@ -117,14 +122,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
-		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER))
+		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -144,9 +155,13 @@ int init_program()
 		return 1;
 	}
 
+	cache_save(program);
+
 	glPatchParameteri(GL_PATCH_VERTICES, 10);
-	glPatchParameterfv(GL_PATCH_DEFAULT_OUTER_LEVEL, (GLfloat[3]) { 16, 16, 16 });
-	glPatchParameterfv(GL_PATCH_DEFAULT_INNER_LEVEL, (GLfloat[1]) { 5 });
+
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
 
 	return 0;
 }
@@ -156,22 +171,32 @@ void render()
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	glUseProgram(program);
+	profile_begin(0);
 	glDrawArrays(GL_PATCHES,0, 10);
+	profile_end(0);
 
 	glUseProgram(0);
+	profile_begin(1);
 	glDrawArrays(GL_POINTS,0,10);
+	profile_end(1);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
 }
 
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
+	profile_init();
+
 	// VBO data
 	//    0
 	//   1,2
@@ -201,6 +226,8 @@ int main(int argc, char* args[])
 	glEnableVertexAttribArray(0);
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GLfloat), NULL);
 	glBufferData(GL_ARRAY_BUFFER, 2 * 10 * sizeof(GLfloat), control_points, GL_STATIC_DRAW);
+	// The patches are polynomial, see the vertex shader.
+	glVertexAttrib1f(1, 1.0f);
 
 	glPointSize(6);
 	render();
@@ -210,36 +237,58 @@ int main(int argc, char* args[])
 
 	while (SDL_WaitEvent(&e))
 	{
-		if (e.type == SDL_QUIT)
-			break;
+		profile_cpu_start = SDL_GetPerformanceCounter();
+
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = 0;
+
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
+
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
+
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+				for (int i = 0; i < 10; i++)
+				{
+					const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_points[2 * i]) - e.button.x;
+					const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_points[2 * i + 1]) - e.button.y;
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+					if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
+						vertex_selection = i;
+				}
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 10; i++)
+			if (e.type == SDL_MOUSEMOTION)
 			{
-				const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_points[2 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_points[2 * i + 1]) - e.button.y;
+				if (vertex_selection < 0)
+					continue;
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-					vertex_selection = i;
-			}
+				profile_event(e.motion.timestamp);
 
-		if (e.type == SDL_MOUSEMOTION)
-		{
-			if (vertex_selection < 0)
-				continue;
+				control_points[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
+				control_points[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
 
-			control_points[2* vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_points[2* vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+				moved = 1;
+			}
+		} while (SDL_PollEvent(&e));
+
+		if (quit)
+			break;
 
+		if (moved)
+		{
 			glBufferData(GL_ARRAY_BUFFER, 2 * 10 * sizeof(GLfloat), control_points, GL_STATIC_DRAW);
 
 			render();
 		}
 	}
 
+	if (profile_log)
+		fclose(profile_log);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
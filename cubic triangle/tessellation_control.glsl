@@ -0,0 +1,97 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#version 430
+layout (vertices = 10) out;
+
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// When set the control points are converted to power basis coefficients for the evaluation shader, as in 'cubic curve'.
+// With u = 1 - v - w the patch is a cubic in v = gl_TessCoord.y and w = gl_TessCoord.z,
+// coefficient k of row r (laid out as the points below) is of v^(r-k) w^k.
+uniform bool power_basis = false;
+
+// Row i holds the points' contributions to coefficient i, which only involves points 0 to i.
+const float bernstein_to_power[100] = float[100](
+	 1, 0, 0, 0, 0, 0, 0, 0, 0, 0,
+	-3, 3, 0, 0, 0, 0, 0, 0, 0, 0,
+	-3, 0, 3, 0, 0, 0, 0, 0, 0, 0,
+	 3,-6, 0, 3, 0, 0, 0, 0, 0, 0,
+	 6,-6,-6, 0, 6, 0, 0, 0, 0, 0,
+	 3, 0,-6, 0, 0, 3, 0, 0, 0, 0,
+	-1, 3, 0,-3, 0, 0, 1, 0, 0, 0,
+	-3, 6, 3,-3,-6, 0, 0, 3, 0, 0,
+	-3, 3, 6, 0,-6,-3, 0, 0, 3, 0,
+	-1, 0, 3, 0, 0,-3, 0, 0, 0, 1);
+
+// The line strip through n uniform samples of a cubic is within 3/4 max|P_i - 2P_{i+1} + P_{i+2}| / n^2 of the curve.
+// Rational edges are measured as in 'cubic curve', on their projected points with the bound scaled by w_max / w_min.
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float cubic_level(vec4 q0, vec4 q1, vec4 q2, vec4 q3)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	vec2 p0 = scale * q0.xy / q0.w;
+	vec2 p1 = scale * q1.xy / q1.w;
+	vec2 p2 = scale * q2.xy / q2.w;
+	vec2 p3 = scale * q3.xy / q3.w;
+
+	float ratio = max(max(q0.w, q1.w), max(q2.w, q3.w)) / min(min(q0.w, q1.w), min(q2.w, q3.w));
+
+	float flatness = ratio * max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+float cubic_level(int i, int j, int k, int l)
+{
+	return cubic_level(
+		gl_in[i].gl_Position,
+		gl_in[j].gl_Position,
+		gl_in[k].gl_Position,
+		gl_in[l].gl_Position);
+}
+
+//    0
+//   1,2
+//  3,4,5
+// 6,7,8,9
+//
+// Point 0 is the corner gl_TessCoord.x = 1, 6 is y = 1 and 9 is z = 1.
+// Outer level i is for the edge where component i of gl_TessCoord is zero.
+
+void main(void)
+{
+	if(gl_InvocationID == 0)
+	{
+		gl_TessLevelOuter[0] = cubic_level(6, 7, 8, 9);
+		gl_TessLevelOuter[1] = cubic_level(0, 2, 5, 9);
+		gl_TessLevelOuter[2] = cubic_level(0, 1, 3, 6);
+
+		gl_TessLevelInner[0] = max(gl_TessLevelOuter[0], max(gl_TessLevelOuter[1], gl_TessLevelOuter[2]));
+	}
+
+	if (power_basis)
+	{
+		vec4 c = vec4(0.0);
+
+		for (int j = 0; j <= gl_InvocationID; j++)
+			c += bernstein_to_power[10 * gl_InvocationID + j] * gl_in[j].gl_Position;
+
+		gl_out[gl_InvocationID].gl_Position = c;
+	}
+	else
+		gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+}
\ No newline at end of file
@@ -6,6 +6,9 @@
 layout (triangles) in;
 layout (location = 0) out vec3 barycoordinates;
 
+// See the control shader.
+uniform bool power_basis = false;
+
 //    0
 //   1,2
 //  3,4,5
@@ -13,10 +16,27 @@ layout (location = 0) out vec3 barycoordinates;
 
 void main(void)
 {
-    vec2 control_points[10];
+    // Sums the powers of w of cubics in v: coefficients 0,1,3,6 are of w^0, 2,4,7 of w^1, 5,8 of w^2 and 9 of w^3.
+    if (power_basis)
+    {
+        float v = gl_TessCoord.y;
+        float w = gl_TessCoord.z;
+
+        vec3 g0 = ((gl_in[6].gl_Position.xyw * v + gl_in[3].gl_Position.xyw) * v + gl_in[1].gl_Position.xyw) * v + gl_in[0].gl_Position.xyw;
+        vec3 g1 = (gl_in[7].gl_Position.xyw * v + gl_in[4].gl_Position.xyw) * v + gl_in[2].gl_Position.xyw;
+        vec3 g2 = gl_in[8].gl_Position.xyw * v + gl_in[5].gl_Position.xyw;
+        vec3 c = ((gl_in[9].gl_Position.xyw * w + g2) * w + g1) * w + g0;
+
+        gl_Position = vec4(c.xy,0,c.z);
+        barycoordinates = gl_TessCoord;
+        return;
+    }
+
+    // Homogeneous (w*x, w*y, w), the division is left to the GL.
+    vec3 control_points[10];
 
     for(int i = 0; i < 10; i++)
-        control_points[i] = gl_in[i].gl_Position.xy;
+        control_points[i] = gl_in[i].gl_Position.xyw;
 
     for(int i = 3; i>0; i--)
     for(int j = 0; j<i; j++)
@@ -29,7 +49,7 @@ void main(void)
             +control_points[idx+j+2]*gl_TessCoord.z;
     }
 
-    gl_Position = vec4(control_points[0],0,1);
+    gl_Position = vec4(control_points[0].xy,0,control_points[0].z);
 
     barycoordinates = gl_TessCoord;
 }
\ No newline at end of file
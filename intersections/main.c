@@ -4,7 +4,11 @@
 
 #include <SDL.h>
 #include <gl/glew.h>
+#include "../bezier/bezier.h"
 #include <stdio.h>
+#include <string.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT SCREEN_WIDTH
@@ -16,6 +20,9 @@ GLuint VBO = 0;
 
 GLuint program = 0;
 
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
 GLfloat control_point[18] = {
 	// curve
 	-0.5, -0.0,
@@ -33,6 +40,23 @@ GLfloat control_point[18] = {
 	 2.0,  0.0
 };
 
+// The intersections are solved on a worker stage while the previous frame draws, see bezier_stage in bezier/bezier.h.
+// Each solve works on a copy of the curve, two alternate so an edit can be submitted while the last is still in flight.
+struct solve
+{
+	struct bezier_batch batch;
+	GLfloat curve[8];
+	GLfloat point[6];
+	int submitted;
+};
+
+struct bezier_stage* stage = NULL;
+struct solve solves[2];
+Uint32 solved_event = 0;
+
+// Worker threads, the stage is sized for scenes of many curves but this one has a single curve.
+int threads = 1;
+
 int init_sdl()
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 ||
@@ -136,14 +160,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
-		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER))
+		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -163,8 +193,13 @@ int init_program()
 		return 1;
 	}
 
+	cache_save(program);
+
 	glPatchParameteri(GL_PATCH_VERTICES, 4);
-	glPatchParameterfv(GL_PATCH_DEFAULT_OUTER_LEVEL, (GLfloat[2]) { 1.0, 128.0 });
+
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
 
 	return 0;
 }
@@ -174,187 +209,107 @@ void render()
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	glUseProgram(program);
+	profile_begin(0);
 	glDrawArrays(GL_PATCHES, 0, 4);
+	profile_end(0);
 
 	glUseProgram(0);
+	profile_begin(1);
 	glDrawArrays(GL_POINTS, 0, 7);
 	glDrawArrays(GL_LINES, 7, 2);
+	profile_end(1);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
 }
 
-void bezier(GLfloat intersections[3])
+// The batch is the one curve, so it's solved once for the range rather than once per index.
+void solve_curves(struct bezier_batch* batch, size_t begin, size_t end)
 {
-	float buffer[6];
-
-	for (int i = 0; i < 3; i++)
-	{
-		GLfloat t = intersections[i];
-		if (t < 0 || t > 1)
-		{
-			control_point[8 + i * 2] = 2;
-			control_point[9 + i * 2] = 2;
+	struct solve* solve = batch->context;
 
-			continue;
-		}
+	if (begin >= end)
+		return;
 
-		buffer[0] = (1 - t) * control_point[0] + t * control_point[2];
-		buffer[1] = (1 - t) * control_point[1] + t * control_point[3];
-		buffer[2] = (1 - t) * control_point[2] + t * control_point[4];
-		buffer[3] = (1 - t) * control_point[3] + t * control_point[5];
-		buffer[4] = (1 - t) * control_point[4] + t * control_point[6];
-		buffer[5] = (1 - t) * control_point[5] + t * control_point[7];
+	float root[3], x[3], y[3];
+	int count;
 
-		buffer[0] = (1 - t) * buffer[0] + t * buffer[2];
-		buffer[1] = (1 - t) * buffer[1] + t * buffer[3];
-		buffer[2] = (1 - t) * buffer[2] + t * buffer[4];
-		buffer[3] = (1 - t) * buffer[3] + t * buffer[5];
+	// The x-axis isn't editable, so it's read in place.
+	bezier_intersect_lines(1, solve->curve, control_point + 14, 0, BEZIER_BISECTION, root, &count);
+	bezier_cubic_curve(solve->curve, count, root, x, y);
 
-		control_point[8+i*2] = (1 - t) * buffer[0] + t * buffer[2];
-		control_point[9+i*2] = (1 - t) * buffer[1] + t * buffer[3];
+	// Points for missing intersections are parked off screen.
+	for (int i = 0; i < 3; i++)
+	{
+		solve->point[2 * i] = i < count ? x[i] : 2;
+		solve->point[2 * i + 1] = i < count ? y[i] : 2;
 	}
 }
 
-int discard(GLfloat a[4])
+// Wakes the event loop, called on the stage's leader.
+void solve_finished(void* context)
 {
-	return (((a[0] < 0) ^ (a[1] > 0)) || (a[0] == 0) || (a[1] == 0))
-		&& (((a[2] < 0) ^ (a[1] > 0)) || (a[2] == 0) || (a[1] == 0))
-		&& (((a[2] < 0) ^ (a[3] > 0)) || (a[2] == 0) || (a[3] == 0));
+	(void)context;
+
+	SDL_PushEvent(&(SDL_Event){ .type = solved_event });
 }
 
-void intersect(GLfloat* intersections)
+// Returns non-zero if both solves are in flight.
+int submit_solve()
 {
-	intersections[0] = -1;
-	intersections[1] = -1;
-	intersections[2] = -1;
-	 
-	const GLfloat a[4] =
-	{
-		control_point[1],
-		control_point[3],
-		control_point[5],
-		control_point[7],
-	};
-
-	if (discard(a))
-		return;
-
-	if(a[0] == 0)
-		*(intersections++) = 0;
-
-	if (a[3] == 0)
-		*(intersections++) = 1;
-
-	// Note that the stack height is bound by the variation diminishing property since the subdivision is a piecewise linear interpolation.
-	struct stack_frame {
-		GLfloat low, high;
-		GLfloat p[4];
-	} stack_base[2], *stack = stack_base;
-
-	GLfloat low = 0.0;
-	GLfloat high = 1.0;
-
-	GLfloat b[7];
-
-	b[0] = a[0];
-	b[2] = a[1];
-	b[4] = a[2];
-	b[6] = a[3];
-
-	for (int i = 0; i < 1000; i++)
+	for (int i = 0; i < 2; i++)
 	{
-		while (high - low < 0.0001)
-		{
-			*(intersections++) = low;
-
-			if (stack < stack_base)
-				return;
-
-			low = (--stack)->low;
-			high = stack->high;
-
-			b[0] = stack->p[0];
-			b[2] = stack->p[1];
-			b[4] = stack->p[2];
-			b[6] = stack->p[3];
-		}
-
-		b[1] = 0.5 * (b[0] + b[2]);
-		b[3] = 0.5 * (b[2] + b[4]);
-		b[5] = 0.5 * (b[4] + b[6]);
-
-		b[2] = 0.5 * (b[1] + b[3]);
-		b[4] = 0.5 * (b[3] + b[5]);
-
-		b[3] = 0.5 * (b[2] + b[4]);
-
-		if (b[3] == 0)
-			*(intersections++) = 0.5 * (low + high);
-
-		const int discard_low = discard(b);
-		const int discard_high = discard(b + 3);
-
-		if (discard_low ^ discard_high)
-		{
-			if (discard_high)
-			{
-				b[6] = b[3];
-				b[4] = b[2];
-				b[2] = b[1];
-
-				high = 0.5 * (low + high);
-			}
-			else
-			{
-				b[0] = b[3];
-				b[2] = b[4];
-				b[4] = b[5];
-
-				low = 0.5 * (low + high);
-			}
+		struct solve* solve = &solves[i];
 
+		if (solve->submitted)
 			continue;
-		}
 
-		if (discard_high)
-		{
-			if (stack < stack_base)
-				return;
+		memcpy(solve->curve, control_point, sizeof(solve->curve));
+		solve->batch = (struct bezier_batch){ .function = solve_curves, .count = 1, .grain = 1, .finished = solve_finished, .context = solve };
+		solve->submitted = !bezier_stage_submit(stage, &solve->batch);
 
-			low = (--stack)->low;
-			high = stack->high;
-
-			b[0] = stack->p[0];
-			b[2] = stack->p[1];
-			b[4] = stack->p[2];
-			b[6] = stack->p[3];
-
-			continue;
-		}
+		return !solve->submitted;
+	}
 
-		const GLfloat mid = 0.5 * (low + high);
-		*(stack++) = (struct stack_frame){ .low = low, .high = mid,.p = {b[0],b[1],b[2],b[3]} };
+	return 1;
+}
 
-		b[0] = b[3];
-		b[2] = b[4];
-		b[4] = b[5];
+// Copies the newest finished solve's intersections to the points drawn, returns non-zero if there was one.
+int take_solves()
+{
+	struct bezier_batch* batch;
+	struct solve* newest = NULL;
 
-		low = mid;
+	while ((batch = bezier_stage_take(stage)))
+	{
+		newest = batch->context;
+		newest->submitted = 0;
 	}
 
-	*intersections = 0.5 * (low + high);
+	if (!newest)
+		return 0;
+
+	memcpy(control_point + 8, newest->point, sizeof(newest->point));
 
-	return;
+	return 1;
 }
 
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
+	if (argc > 2)
+		threads = atoi(args[2]);
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
+	profile_init();
+
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
 	glEnableVertexAttribArray(0);
@@ -364,52 +319,99 @@ int main(int argc, char* args[])
 	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 0, NULL);
 
 	glPointSize(6);
-	
-	GLfloat intersections[3];
-	intersect(intersections);
-	bezier(intersections);
 
-	glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
-	
+	stage = bezier_stage_create(threads, 2);
+	solved_event = SDL_RegisterEvents(1);
+
+	if (!stage || solved_event == (Uint32)-1)
+	{
+		printf("Unable to start the solve stage\n");
+		return 0;
+	}
+
+	// The first solve is drawn when it returns.
+	glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(GLfloat), control_point, GL_DYNAMIC_DRAW);
+	submit_solve();
+
 	render();
 
 	SDL_Event e;
 	int vertex_selection = -1;
+	int stale = 0;
 
 	while (SDL_WaitEvent(&e))
 	{
-		if (e.type == SDL_QUIT)
-			break;
+		profile_cpu_start = SDL_GetPerformanceCounter();
+
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = 0;
+		int solved = 0;
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 4; i++)
+			if (e.type == solved_event)
+				solved = 1;
+
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
+
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+				for (int i = 0; i < 4; i++)
+				{
+					const GLint dx = SCREEN_WIDTH * (0.5f + 0.5f * control_point[2 * i]) - e.button.x;
+					const GLint dy = SCREEN_HEIGHT * (0.5f - +0.5f * control_point[2 * i + 1]) - e.button.y;
+
+					if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
+						vertex_selection = i;
+				}
+
+			if (e.type == SDL_MOUSEMOTION)
 			{
-				const GLint dx = SCREEN_WIDTH * (0.5f + 0.5f * control_point[2 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f - +0.5f * control_point[2 * i + 1]) - e.button.y;
+				if (vertex_selection < 0)
+					continue;
+
+				profile_event(e.motion.timestamp);
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-					vertex_selection = i;
+				control_point[2 * vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
+				control_point[2 * vertex_selection + 1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+
+				moved = 1;
 			}
+		} while (SDL_PollEvent(&e));
+
+		if (quit)
+			break;
 
-		if (e.type == SDL_MOUSEMOTION)
+		// The curve is drawn where it was moved to straight away, its intersections once they're solved.
+		// An edit made while both solves are in flight is submitted when one returns.
+		if (moved)
 		{
-			if (vertex_selection < 0)
-				continue;
+			stale = submit_solve();
+
+			glBufferSubData(GL_ARRAY_BUFFER, 0, 8 * sizeof(GLfloat), control_point);
+		}
 
-			control_point[2 * vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_point[2 * vertex_selection + 1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+		if (solved && take_solves())
+		{
+			if (stale)
+				stale = submit_solve();
 
-			intersect(intersections);
-			bezier(intersections);
+			glBufferSubData(GL_ARRAY_BUFFER, 8 * sizeof(GLfloat), 6 * sizeof(GLfloat), control_point + 8);
+		}
 
-			glBufferData(GL_ARRAY_BUFFER, 18 * sizeof(GLfloat), control_point, GL_STATIC_DRAW);
+		if (moved || solved)
 			render();
-		}
 	}
 
+	bezier_stage_destroy(stage);
+
+	if (profile_log)
+		fclose(profile_log);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
@@ -0,0 +1,50 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#version 430
+layout (vertices = 4) out;
+
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// The line strip through n uniform samples of a cubic is within 3/4 max|P_i - 2P_{i+1} + P_{i+2}| / n^2 of the curve.
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float cubic_level(vec2 p0, vec2 p1, vec2 p2, vec2 p3)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	p0 *= scale;
+	p1 *= scale;
+	p2 *= scale;
+	p3 *= scale;
+
+	float flatness = max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+void main(void)
+{
+	if(gl_InvocationID == 0)
+	{
+		gl_TessLevelOuter[0] = 1.0;
+		gl_TessLevelOuter[1] = cubic_level(
+			gl_in[0].gl_Position.xy,
+			gl_in[1].gl_Position.xy,
+			gl_in[2].gl_Position.xy,
+			gl_in[3].gl_Position.xy);
+	}
+
+	gl_out[gl_InvocationID].gl_Position = gl_in[gl_InvocationID].gl_Position;
+}
\ No newline at end of file
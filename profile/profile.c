@@ -0,0 +1,141 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#include "profile.h"
+
+#include <stdlib.h>
+
+#define PROFILE_STAGES 2
+#define PROFILE_SMOOTHING 0.1
+
+enum { PROFILE_PRIMITIVES = PROFILE_STAGES, PROFILE_INVOCATIONS, PROFILE_QUERIES };
+
+FILE* profile_log = NULL;
+static GLuint profile_query[2][PROFILE_QUERIES];
+static double profile_cpu_ms[2];
+static double profile_latency_ms[2];
+static int profile_events[2];
+static int profile_frame = 0;
+static int profile_samples = 0;
+static int profile_statistics = 0;
+Uint64 profile_cpu_start = 0;
+static Uint32 profile_event_ticks = 0;
+static int profile_event_count = 0;
+static double profile_average[PROFILE_STAGES + 2] = { 0 };
+
+void profile_init()
+{
+	const char* path = getenv("TESSELLATION_PROFILE");
+
+	if (!path)
+		return;
+
+	fopen_s(&profile_log, path, "w");
+
+	if (!profile_log)
+	{
+		printf("Unable to write: %s\n", path);
+		return;
+	}
+
+	glGenQueries(2 * PROFILE_QUERIES, profile_query[0]);
+	profile_statistics = GLEW_ARB_pipeline_statistics_query;
+	profile_cpu_start = SDL_GetPerformanceCounter();
+
+	fprintf(profile_log, "frame,cpu_ms,patches_ms,overlay_ms,primitives,evaluation_invocations,latency_ms,events\n");
+}
+
+void profile_event(Uint32 timestamp)
+{
+	if (!profile_log)
+		return;
+
+	if (profile_event_count++ == 0)
+		profile_event_ticks = timestamp;
+}
+
+void profile_begin(int stage)
+{
+	if (!profile_log)
+		return;
+
+	GLuint* query = profile_query[profile_frame % 2];
+
+	if (stage == 0)
+	{
+		profile_cpu_ms[profile_frame % 2] = 1e3 * (SDL_GetPerformanceCounter() - profile_cpu_start) / SDL_GetPerformanceFrequency();
+
+		glBeginQuery(GL_PRIMITIVES_GENERATED, query[PROFILE_PRIMITIVES]);
+
+		if (profile_statistics)
+			glBeginQuery(GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB, query[PROFILE_INVOCATIONS]);
+	}
+
+	glBeginQuery(GL_TIME_ELAPSED, query[stage]);
+}
+
+void profile_end(int stage)
+{
+	if (!profile_log)
+		return;
+
+	glEndQuery(GL_TIME_ELAPSED);
+
+	if (stage == 0)
+	{
+		glEndQuery(GL_PRIMITIVES_GENERATED);
+
+		if (profile_statistics)
+			glEndQuery(GL_TESS_EVALUATION_SHADER_INVOCATIONS_ARB);
+	}
+}
+
+void profile_frame_end(SDL_Window* window)
+{
+	if (!profile_log)
+		return;
+
+	// Unlike the queries the latency is known as soon as the swap returns.
+	profile_latency_ms[profile_frame % 2] = profile_event_count ? SDL_GetTicks() - profile_event_ticks : 0;
+	profile_events[profile_frame % 2] = profile_event_count;
+	profile_event_count = 0;
+
+	if (profile_frame++ == 0)
+		return;
+
+	GLuint* query = profile_query[profile_frame % 2];
+	GLuint available = GL_FALSE;
+
+	// The overlay's timer is the last query ended.
+	glGetQueryObjectuiv(query[1], GL_QUERY_RESULT_AVAILABLE, &available);
+
+	if (!available)
+		return;
+
+	GLuint64 elapsed[PROFILE_STAGES];
+	GLuint64 primitives = 0, invocations = 0;
+
+	for (int i = 0; i < PROFILE_STAGES; i++)
+		glGetQueryObjectui64v(query[i], GL_QUERY_RESULT, &elapsed[i]);
+
+	glGetQueryObjectui64v(query[PROFILE_PRIMITIVES], GL_QUERY_RESULT, &primitives);
+
+	if (profile_statistics)
+		glGetQueryObjectui64v(query[PROFILE_INVOCATIONS], GL_QUERY_RESULT, &invocations);
+
+	const double sample[PROFILE_STAGES + 2] = { profile_cpu_ms[profile_frame % 2], 1e-6 * elapsed[0], 1e-6 * elapsed[1], profile_latency_ms[profile_frame % 2] };
+
+	for (int i = 0; i < PROFILE_STAGES + 2; i++)
+		profile_average[i] = profile_samples == 0 ? sample[i] : profile_average[i] + PROFILE_SMOOTHING * (sample[i] - profile_average[i]);
+
+	profile_samples++;
+
+	fprintf(profile_log, "%d,%.4f,%.4f,%.4f,%llu,%llu,%.0f,%d\n", profile_frame - 2, sample[0], sample[1], sample[2],
+		(unsigned long long)primitives, (unsigned long long)invocations, sample[3], profile_events[profile_frame % 2]);
+
+	char title[256];
+	snprintf(title, sizeof(title), "bezier tesselation - cpu %.3f ms, patches %.3f ms, overlay %.3f ms, latency %.1f ms, %llu primitives",
+		profile_average[0], profile_average[1], profile_average[2], profile_average[3], (unsigned long long)primitives);
+	SDL_SetWindowTitle(window, title);
+}
@@ -0,0 +1,38 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+// The demonstrations' profiler, included by each main.c and built from profile/profile.c.
+#ifndef PROFILE_H
+#define PROFILE_H
+
+#include <SDL.h>
+#include <gl/glew.h>
+#include <stdio.h>
+
+// Opt-in instrumentation, enabled by naming a CSV log in the TESSELLATION_PROFILE environment variable.
+// Each frame times the CPU work since the event was received and, with GL_TIME_ELAPSED queries, the patches' and the overlay's draws,
+// counting the tessellated primitives (and evaluation shader invocations where ARB_pipeline_statistics_query is available).
+// Queries are double buffered and a frame's results are only read during the next frame once available so they never stall.
+// Each frame also records the input latency, from the oldest event it applies to the return of its swap, see profile_event.
+// Rolling averages are shown in the window title.
+
+// The log, NULL unless profiling, for the demonstrations to close.
+extern FILE* profile_log;
+
+// When the frame's CPU work started, set as each frame's first event is received.
+extern Uint64 profile_cpu_start;
+
+void profile_init();
+
+// Called for each input event the next frame applies (with the event's timestamp), events coalesced into one frame count once.
+void profile_event(Uint32 timestamp);
+
+// Stage 0 is the patches' draw, stage 1 the overlay's.
+void profile_begin(int stage);
+void profile_end(int stage);
+
+// Reads the previous frame's queries if the GPU is done with them, otherwise that frame's sample is dropped.
+void profile_frame_end(SDL_Window* window);
+
+#endif
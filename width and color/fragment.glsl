@@ -4,12 +4,19 @@
 
 #version 430
 
-layout(location = 0) in vec3 color;
+// The color and the distance along the path.
+layout(location = 0) in vec4 stroke;
 layout(location = 0) out vec4 diffuseColor;
 
 uniform float weight;
 
+// Lengths of the dashes and the gaps between them along the path, solid if the gap is zero.
+uniform vec2 dash = vec2(0.0);
+
 void main()
 {
-	diffuseColor = vec4(color,1.0);
+	if (dash.y > 0.0 && mod(stroke.w, dash.x + dash.y) > dash.x)
+		discard;
+
+	diffuseColor = vec4(stroke.rgb,1.0);
 }
\ No newline at end of file
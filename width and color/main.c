@@ -4,7 +4,11 @@
 
 #include <SDL.h>
 #include <gl/glew.h>
+#include <math.h>
 #include <stdio.h>
+#include <string.h>
+#include "../profile/profile.h"
+#include "../cache/cache.h"
 
 #define SCREEN_WIDTH 640
 #define SCREEN_HEIGHT SCREEN_WIDTH
@@ -13,17 +17,108 @@ SDL_Window* window = NULL;
 
 GLuint VAO = 0;
 GLuint VBO = 0;
+GLuint IBO = 0;
 
 GLuint program = 0;
 
-// x,y,width,r,g,b
+// Tessellation levels are chosen so the tessellation is within this many pixels of the patch, see tessellation_control.glsl.
+GLfloat pixel_error = 0.5;
+
+// Matching the shaders' definitions.
+enum join { JOIN_MITER, JOIN_ROUND, JOIN_BEVEL };
+enum cap { CAP_BUTT, CAP_ROUND, CAP_SQUARE };
+
+const char* join_name[] = { "miter", "round", "bevel" };
+const char* cap_name[] = { "butt", "round", "square" };
+
+enum join join = JOIN_MITER;
+enum cap cap = CAP_BUTT;
+
+// Dash and gap length, solid if zero.
+GLfloat dash = 0.0f;
+
+// x,y,width,r,g,b,distance
+// The path's cubic segments share their end points, the distance is the path's arc length up to each segment's first point.
+// The middle segment's P_2 is retracted onto its P_3, a corner the stroke's tangents must survive.
+#define SEGMENTS 3
+#define POINTS (3 * SEGMENTS + 1)
+#define STRIDE 7
+
 GLfloat control_points[] = {
-	-0.5, 0.0, 0.015, 1.0, 0.0, 0.0,
-	-0.2, 0.4, 0.075, 0.7, 0.0, 0.3,
-	 0.2,-0.4, -0.02, 0.3, 0.0, 0.7, 
-	 0.5, 0.0, 0.05, 0.0, 0.0, 1.0,
+	-0.8,-0.2, 0.030, 1.0, 0.0, 0.0, 0.0,
+	-0.7, 0.4, 0.060, 0.8, 0.0, 0.2, 0.0,
+	-0.4, 0.4, 0.040, 0.7, 0.0, 0.3, 0.0,
+	-0.3, 0.0, 0.050, 0.6, 0.0, 0.4, 0.0,
+	 0.0, 0.2, 0.030, 0.5, 0.0, 0.5, 0.0,
+	 0.3,-0.3, 0.040, 0.4, 0.0, 0.6, 0.0,
+	 0.3,-0.3, 0.060, 0.3, 0.0, 0.7, 0.0,
+	 0.4, 0.1, 0.040, 0.2, 0.0, 0.8, 0.0,
+	 0.7, 0.3, 0.050, 0.1, 0.0, 0.9, 0.0,
+	 0.8,-0.2, 0.030, 0.0, 0.0, 1.0, 0.0,
 };
 
+// Each segment's patch is its four control points and the next segment's other three, for the join's outgoing tangent.
+// The last segment repeats its end point instead, see tessellation_control.glsl.
+#define PATCH_VERTICES 7
+
+GLuint indices[PATCH_VERTICES * SEGMENTS];
+
+void init_indices()
+{
+	for (int i = 0; i < SEGMENTS; i++)
+	{
+		GLuint* index = indices + PATCH_VERTICES * i;
+
+		for (int j = 0; j < PATCH_VERTICES; j++)
+			index[j] = i == SEGMENTS - 1 && j > 3 ? 3 * i + 3 : 3 * i + j;
+	}
+}
+
+// Sums the same chords as the control shader's arc length table so dashes continue across the joins.
+void update_distances()
+{
+	GLfloat distance = 0.0f;
+
+	for (int i = 0; i < SEGMENTS; i++)
+	{
+		const GLfloat* p[4];
+
+		for (int j = 0; j < 4; j++)
+			p[j] = control_points + STRIDE * (3 * i + j);
+
+		for (int j = 0; j < 3; j++)
+			control_points[STRIDE * (3 * i + j) + 6] = distance;
+
+		GLfloat previous[2] = { p[0][0], p[0][1] };
+
+		for (int k = 1; k <= 16; k++)
+		{
+			const GLfloat t = k / 16.0f, s = 1.0f - t;
+			GLfloat point[2];
+
+			for (int c = 0; c < 2; c++)
+				point[c] = s * s * s * p[0][c] + 3.0f * s * t * (s * p[1][c] + t * p[2][c]) + t * t * t * p[3][c];
+
+			distance += sqrtf((point[0] - previous[0]) * (point[0] - previous[0]) + (point[1] - previous[1]) * (point[1] - previous[1]));
+
+			previous[0] = point[0];
+			previous[1] = point[1];
+		}
+	}
+
+	control_points[STRIDE * (POINTS - 1) + 6] = distance;
+}
+
+int parse_name(const char* name, const char** names, int count)
+{
+	for (int i = 0; i < count; i++)
+		if (!strcmp(name, names[i]))
+			return i;
+
+	printf("Unknown style: %s\n", name);
+	return 0;
+}
+
 int init_sdl()
 {
 	if (SDL_Init(SDL_INIT_VIDEO) < 0 || 
@@ -127,15 +222,20 @@ int init_program()
 {
 	program = glCreateProgram();
 
-	if (
-		attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
+	// A binary cached by an earlier run skips compiling the shaders, see cache/cache.h.
+	const int cached = !cache_load(program, 4, (const char* []) { "vertex.glsl", "fragment.glsl", "tessellation_evaluation.glsl", "tessellation_control.glsl" });
+
+	if (!cached &&
+		(attach_shader("vertex.glsl", GL_VERTEX_SHADER) ||
 		attach_shader("fragment.glsl", GL_FRAGMENT_SHADER) ||
-		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER))
+		attach_shader("tessellation_evaluation.glsl", GL_TESS_EVALUATION_SHADER) ||
+		attach_shader("tessellation_control.glsl", GL_TESS_CONTROL_SHADER)))
 	{
 		return 1;
 	}
 
-	glLinkProgram(program);
+	if (!cached)
+		glLinkProgram(program);
 
 	GLint program_link_status = GL_TRUE;
 	glGetProgramiv(program, GL_LINK_STATUS, &program_link_status);
@@ -155,17 +255,32 @@ int init_program()
 		return 1;
 	}
 
-	glPatchParameteri(GL_PATCH_VERTICES, 4);
-	glPatchParameterfv(GL_PATCH_DEFAULT_OUTER_LEVEL, (GLfloat[4]) { 1, 64, 1, 64 });
-	glPatchParameterfv(GL_PATCH_DEFAULT_INNER_LEVEL, (GLfloat[2]) { 8, 8 });
+	cache_save(program);
+
+	glPatchParameteri(GL_PATCH_VERTICES, PATCH_VERTICES);
+
+	glUseProgram(program);
+	glUniform1f(glGetUniformLocation(program, "pixel_error"), pixel_error);
+	glUniform2f(glGetUniformLocation(program, "viewport"), SCREEN_WIDTH, SCREEN_HEIGHT);
+	glUniform1i(glGetUniformLocation(program, "join"), join);
+	glUniform1i(glGetUniformLocation(program, "cap"), cap);
+	glUniform1i(glGetUniformLocation(program, "segments"), SEGMENTS);
+	glUniform2f(glGetUniformLocation(program, "dash"), dash, dash);
 
 	return 0;
 }
 
-void bind_control_points()
+// The buffer's storage is allocated once, afterwards only the moved control point and the distances after it are written.
+void bind_control_points(int point)
 {
+	update_distances();
+
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glBufferData(GL_ARRAY_BUFFER, sizeof(control_points), control_points, GL_STATIC_DRAW);
+
+	if (point < 0)
+		glBufferData(GL_ARRAY_BUFFER, sizeof(control_points), control_points, GL_DYNAMIC_DRAW);
+	else
+		glBufferSubData(GL_ARRAY_BUFFER, STRIDE * point * sizeof(GLfloat), STRIDE * (POINTS - point) * sizeof(GLfloat), control_points + STRIDE * point);
 }
 
 void render()
@@ -173,40 +288,70 @@ void render()
 	glClear(GL_COLOR_BUFFER_BIT);
 
 	glUseProgram(program);
-	glDrawArrays(GL_PATCHES, 0, 4);
+	profile_begin(0);
+	glDrawElements(GL_PATCHES, PATCH_VERTICES * SEGMENTS, GL_UNSIGNED_INT, NULL);
+	profile_end(0);
 
 	glUseProgram(0);
-	glDrawArrays(GL_POINTS, 0, 4);
+	profile_begin(1);
+	glDrawArrays(GL_POINTS, 0, POINTS);
+	profile_end(1);
 
 	SDL_GL_SwapWindow(window);
+	profile_frame_end(window);
 }
 
+// Usage: width_and_color [pixel_error] [miter|round|bevel] [butt|round|square] [dash length]
 int main(int argc, char* args[])
 {
+	if (argc > 1)
+		pixel_error = (GLfloat)atof(args[1]);
+
+	if (argc > 2)
+		join = parse_name(args[2], join_name, 3);
+
+	if (argc > 3)
+		cap = parse_name(args[3], cap_name, 3);
+
+	if (argc > 4)
+		dash = (GLfloat)atof(args[4]);
+
 	if (init_sdl())
 		return 0;
 
 	if (init_program())
 		return 0;
 
+	profile_init();
+
 	glGenVertexArrays(1, &VAO);
 	glBindVertexArray(VAO);
 
 	glGenBuffers(1, &VBO);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), NULL);
+	glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, STRIDE * sizeof(GLfloat), NULL);
 	glEnableVertexAttribArray(0);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), 2 * sizeof(GLfloat));
+	glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, STRIDE * sizeof(GLfloat), 2 * sizeof(GLfloat));
 	glEnableVertexAttribArray(1);
 
 	glBindBuffer(GL_ARRAY_BUFFER, VBO);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 6 * sizeof(GLfloat), 3*sizeof(GLfloat));
+	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, STRIDE * sizeof(GLfloat), 3*sizeof(GLfloat));
 	glEnableVertexAttribArray(2);
 
-	bind_control_points();
+	glBindBuffer(GL_ARRAY_BUFFER, VBO);
+	glVertexAttribPointer(3, 1, GL_FLOAT, GL_FALSE, STRIDE * sizeof(GLfloat), 6 * sizeof(GLfloat));
+	glEnableVertexAttribArray(3);
+
+	bind_control_points(-1);
+
+	init_indices();
+
+	glGenBuffers(1, &IBO);
+	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, IBO);
+	glBufferData(GL_ELEMENT_ARRAY_BUFFER, sizeof(indices), indices, GL_STATIC_DRAW);
 	
 	glPointSize(6);
 	render();
@@ -216,36 +361,59 @@ int main(int argc, char* args[])
 
 	while (SDL_WaitEvent(&e))
 	{
-		if (e.type == SDL_QUIT)
-			break;
+		profile_cpu_start = SDL_GetPerformanceCounter();
+
+		// Drain everything queued since the last frame so a drag draws once per frame rather than once per motion event.
+		int quit = 0;
+		int moved = POINTS;
+
+		do
+		{
+			if (e.type == SDL_QUIT)
+				quit = 1;
+
+			if (e.type == SDL_MOUSEBUTTONUP)
+				vertex_selection = -1;
 
-		if (e.type == SDL_MOUSEBUTTONUP)
-			vertex_selection = -1;
+			if (e.type == SDL_MOUSEBUTTONDOWN)
+				for (int i = 0; i < POINTS; i++)
+				{
+					const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_points[STRIDE * i]) - e.button.x;
+					const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_points[STRIDE * i + 1]) - e.button.y;
 
-		if (e.type == SDL_MOUSEBUTTONDOWN)
-			for (int i = 0; i < 4; i++)
+					if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
+						vertex_selection = i;
+				}
+
+			if (e.type == SDL_MOUSEMOTION)
 			{
-				const GLint dx = SCREEN_WIDTH * (0.5f +0.5f * control_points[6 * i]) - e.button.x;
-				const GLint dy = SCREEN_HEIGHT * (0.5f  - +0.5f * control_points[6 * i + 1]) - e.button.y;
+				if (vertex_selection < 0)
+					continue;
 
-				if (dx > -3 && dx < 3 && dy > -3 && dy < 3)
-					vertex_selection = i;
-			}
+				profile_event(e.motion.timestamp);
 
-		if (e.type == SDL_MOUSEMOTION)
-		{
-			if (vertex_selection < 0)
-				continue;
+				control_points[STRIDE * vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
+				control_points[STRIDE * vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
 
-			control_points[6 * vertex_selection] = 2.0f * ((float)e.button.x) / ((float)SCREEN_WIDTH) - 1.0f;
-			control_points[6 * vertex_selection+1] = 1.0f - 2.0f * ((float)e.button.y) / ((float)SCREEN_HEIGHT);
+				// Only the points from the first moved on need uploading, see bind_control_points.
+				if (vertex_selection < moved)
+					moved = vertex_selection;
+			}
+		} while (SDL_PollEvent(&e));
 
-			bind_control_points();
+		if (quit)
+			break;
 
+		if (moved < POINTS)
+		{
+			bind_control_points(moved);
 			render();
 		}
 	}
 
+	if (profile_log)
+		fclose(profile_log);
+
 	SDL_DestroyWindow(window);
 	SDL_Quit();
 
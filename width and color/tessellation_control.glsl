@@ -0,0 +1,181 @@
+// Copyright 2025 Kieran W Harvie. All rights reserved.
+// Use of this source code is governed by an MIT-style
+// license that can be found in the LICENSE file.
+
+#version 430
+layout (vertices = 4) out;
+
+// A stroke's segment is its cubic P_0..P_3 followed by the next segment's other three points, which the last segment repeats P_3 for.
+// Patches come in paths of 'segments', the first draws a cap at P_0 and the last one at P_3, the others the join at P_3.
+layout(location = 0) in struct VertexAttrib
+{
+	vec2 pos;
+	float width;
+	vec3 color;
+	float distance;
+} in_data[];
+
+layout(location = 0) out struct VertexAttrib
+{
+	vec2 pos;
+	float width;
+	vec3 color;
+	float distance;
+} out_data[];
+
+// Steps of the fans about P_0 and P_3, segments of the curve and their total, see tessellation_evaluation.glsl.
+patch out vec4 columns;
+
+// Segments a path, the patches' paths ending where gl_PrimitiveID % segments wraps.
+// Passed explicitly rather than detected from repeated points, which a corner with a retracted handle also has,
+// so every path drawn in one call must have this many segments.
+uniform int segments = 1;
+
+// Unit tangents at P_0, at P_3 and leaving P_3 along the next segment, or the one at P_3 again where the path ends.
+patch out vec2 tangent[3];
+
+// Arc length at ARC_SAMPLES + 1 uniform samples, the dashes' distance along the segment.
+#define ARC_SAMPLES 16
+patch out float arc[ARC_SAMPLES + 1];
+
+// Largest distance in pixels between the curve and the tessellated line strip.
+uniform float pixel_error = 0.5;
+uniform vec2 viewport = vec2(640, 640);
+
+// When positive every patch uses this level instead, e.g. for benchmarking.
+uniform float level = 0.0;
+
+// Matching the enumerations in main.c.
+#define JOIN_MITER 0
+#define JOIN_ROUND 1
+#define JOIN_BEVEL 2
+#define CAP_BUTT 0
+#define CAP_ROUND 1
+#define CAP_SQUARE 2
+
+uniform int join = JOIN_MITER;
+uniform int cap = CAP_BUTT;
+
+// Round joins and caps are approximated by at most this many chords.
+#define MAX_ROUND_STEPS 8.0
+#define PI 3.14159265
+
+// The line strip through n uniform samples of a cubic is within 3/4 max|P_i - 2P_{i+1} + P_{i+2}| / n^2 of the curve.
+// More segments than the control polygon has pixels can't be seen so its length caps the level.
+float cubic_level(vec2 p0, vec2 p1, vec2 p2, vec2 p3)
+{
+	if (level > 0.0)
+		return level;
+
+	vec2 scale = 0.5 * viewport;
+
+	p0 *= scale;
+	p1 *= scale;
+	p2 *= scale;
+	p3 *= scale;
+
+	float flatness = max(length(p0 - 2.0 * p1 + p2), length(p1 - 2.0 * p2 + p3));
+	float polygon = length(p1 - p0) + length(p2 - p1) + length(p3 - p2);
+
+	float n = min(ceil(sqrt(0.75 * flatness / pixel_error)), ceil(polygon));
+
+	return clamp(n, 1.0, float(gl_MaxTessGenLevel));
+}
+
+// A chord of a circle of radius r is within e of the arc if it subtends at most 2 acos(1 - e/r).
+float round_steps(float angle, float width)
+{
+	float r = abs(width) * 0.5 * max(viewport.x, viewport.y);
+	float step = r > pixel_error ? 2.0 * acos(1.0 - pixel_error / r) : PI;
+
+	return clamp(ceil(angle / step), 1.0, MAX_ROUND_STEPS);
+}
+
+float cap_steps(float width)
+{
+	if (cap == CAP_SQUARE)
+		return 3.0;
+
+	if (cap == CAP_ROUND)
+		return round_steps(PI, width);
+
+	return 0.0;
+}
+
+// Segments continuing straight on need no join.
+float join_steps(vec2 t0, vec2 t1, float width)
+{
+	float c = dot(t0, t1);
+
+	if (c > 0.99999)
+		return 0.0;
+
+	if (join == JOIN_BEVEL)
+		return 1.0;
+
+	if (join == JOIN_MITER)
+		return 2.0;
+
+	return round_steps(acos(max(c, -1.0)), width);
+}
+
+// The first of the differences that isn't zero, so a handle on its end point doesn't lose the direction.
+vec2 direction(vec2 a, vec2 b, vec2 c)
+{
+	vec2 d = dot(a, a) > 0.0 ? a : dot(b, b) > 0.0 ? b : c;
+
+	return dot(d, d) > 0.0 ? normalize(d) : vec2(1.0, 0.0);
+}
+
+vec2 cubic(float t)
+{
+	float s = 1.0 - t;
+
+	return s * s * s * in_data[0].pos + 3.0 * s * t * (s * in_data[1].pos + t * in_data[2].pos) + t * t * t * in_data[3].pos;
+}
+
+void main(void)
+{
+	// The curve runs along gl_TessCoord.x and across the width along y, which needs no subdivision.
+	if(gl_InvocationID == 0)
+	{
+		vec2 p0 = in_data[0].pos, p1 = in_data[1].pos, p2 = in_data[2].pos, p3 = in_data[3].pos;
+
+		int segment = gl_PrimitiveID % segments;
+		bool first = segment == 0, last = segment == segments - 1;
+
+		tangent[0] = direction(p1 - p0, p2 - p0, p3 - p0);
+		tangent[1] = direction(p3 - p2, p3 - p1, p3 - p0);
+		tangent[2] = last ? tangent[1] : direction(in_data[4].pos - p3, in_data[5].pos - p3, in_data[6].pos - p3);
+
+		float start = first ? cap_steps(in_data[0].width) : 0.0;
+		float end = last ? cap_steps(in_data[3].width) : join_steps(tangent[1], tangent[2], in_data[3].width);
+
+		// A fan of n steps takes n + 1 columns, the extra one joining it to the curve.
+		float fans = (start > 0.0 ? start + 1.0 : 0.0) + (end > 0.0 ? end + 1.0 : 0.0);
+		float n = clamp(cubic_level(p0, p1, p2, p3), 1.0, float(gl_MaxTessGenLevel) - fans);
+
+		columns = vec4(start, n, end, n + fans);
+
+		gl_TessLevelOuter[0] = 1.0;
+		gl_TessLevelOuter[1] = columns.w;
+		gl_TessLevelOuter[2] = 1.0;
+		gl_TessLevelOuter[3] = columns.w;
+
+		gl_TessLevelInner[0] = columns.w;
+		gl_TessLevelInner[1] = 1.0;
+
+		arc[0] = 0.0;
+		vec2 previous = p0;
+
+		for (int i = 1; i <= ARC_SAMPLES; i++)
+		{
+			vec2 p = cubic(float(i) / ARC_SAMPLES);
+
+			arc[i] = arc[i - 1] + length(p - previous);
+			previous = p;
+		}
+	}
+
+	out_data[gl_InvocationID] = in_data[gl_InvocationID];
+}
\ No newline at end of file
@@ -4,16 +4,40 @@
 
 #version 430
 layout(quads) in;
-layout (location = 0) out vec3 color;
+// The color and the distance along the path, for the dashes.
+layout (location = 0) out vec4 stroke;
 
 layout(location = 0) in struct VertexAttrib
 {
 	vec2 pos;
 	float width;
 	vec3 color;
+	float distance;
 } in_data[];
 
-vec2 tangent()
+patch in vec4 columns;
+patch in vec2 tangent[3];
+
+#define ARC_SAMPLES 16
+patch in float arc[ARC_SAMPLES + 1];
+
+// Matching the enumerations in main.c.
+#define JOIN_MITER 0
+#define JOIN_ROUND 1
+#define JOIN_BEVEL 2
+#define CAP_BUTT 0
+#define CAP_ROUND 1
+#define CAP_SQUARE 2
+
+uniform int join = JOIN_MITER;
+uniform int cap = CAP_BUTT;
+
+// Miters longer than this many half widths are beveled.
+uniform float miter_limit = 4.0;
+
+#define PI 3.14159265
+
+vec2 tangent_at(float t)
 {
 	vec2 buff[3];
 
@@ -22,12 +46,12 @@ vec2 tangent()
 
 	for(int i = 2; i >= 0; i--)
 	for(int j = 0; j < i; j++)
-		buff[j] = mix(buff[j],buff[j+1],gl_TessCoord.x);
+		buff[j] = mix(buff[j],buff[j+1],t);
 
 	return buff[0];
 }
 
-VertexAttrib vertexMix()
+VertexAttrib vertexMix(float t)
 {
 	VertexAttrib buff[4];
 
@@ -37,27 +61,116 @@ VertexAttrib vertexMix()
 	for(int i = 3; i >= 0; i--)
 	for(int j = 0; j < i; j++)
 	{
-		buff[j].pos = mix(buff[j].pos,buff[j+1].pos,gl_TessCoord.x);
-		buff[j].width = mix(buff[j].width,buff[j+1].width,gl_TessCoord.x);
-		buff[j].color = mix(buff[j].color,buff[j+1].color,gl_TessCoord.x);
+		buff[j].pos = mix(buff[j].pos,buff[j+1].pos,t);
+		buff[j].width = mix(buff[j].width,buff[j+1].width,t);
+		buff[j].color = mix(buff[j].color,buff[j+1].color,t);
 	}
 
 	return buff[0];
 }
 
+vec2 normal(vec2 t)
+{
+	return vec2(-t.y, t.x);
+}
+
+// Step j of a cap's fan, from n around through d to -n.
+vec2 cap_direction(int j, int steps, vec2 n, vec2 d)
+{
+	if (cap == CAP_SQUARE)
+		return j == 0 ? n : j == 1 ? n + d : j == 2 ? d - n : -n;
+
+	float phi = PI * j / steps;
+
+	return cos(phi) * n + sin(phi) * d;
+}
+
+// Step j of a join's fan on the outside of the turn from t0 to t1.
+vec2 join_direction(int j, int steps, vec2 t0, vec2 t1)
+{
+	float turn = t0.x * t1.y - t0.y * t1.x < 0.0 ? -1.0 : 1.0;
+
+	vec2 o0 = -turn * normal(t0);
+	vec2 o1 = -turn * normal(t1);
+
+	if (j == 0)
+		return o0;
+
+	if (j == steps)
+		return o1;
+
+	// The miter's tip is |o0 + o1| / (1 + o0.o1) along the bisector, sqrt(2 / (1 + o0.o1)) half widths out.
+	float c = 1.0 + dot(o0, o1);
+
+	if (join == JOIN_MITER)
+		return c * miter_limit * miter_limit < 2.0 ? 0.5 * (o0 + o1) : (o0 + o1) / c;
+
+	// Rotating o0 the way the curve turns.
+	float phi = acos(clamp(c - 1.0, -1.0, 1.0)) * j / steps;
+
+	return cos(phi) * o0 + sin(phi) * turn * normal(o0);
+}
+
+// Arc length from the start of the path, the path's length to P_0 plus the table's.
+float distance_at(float t)
+{
+	float f = t * ARC_SAMPLES;
+	int i = min(int(f), ARC_SAMPLES - 1);
+
+	return in_data[0].distance + mix(arc[i], arc[i + 1], f - i);
+}
+
 void main(void)
 {
-	VertexAttrib v = vertexMix();
+	// Along x the columns are the fan about P_0 (if there's a cap), the curve and the fan about P_3 (if there's a cap or join).
+	// A fan's columns run from its center at y = 0 to a point on its rim at y = 1,
+	// the rim starting and ending on the line across the curve's end so the quad joining them to the curve has no area.
+	int column = int(round(gl_TessCoord.x * columns.w));
+
+	int start = int(columns.x);
+	int n = int(columns.y);
+	int end = int(columns.z);
+	int first = start > 0 ? start + 1 : 0;
+
+	if (column < first)
+	{
+		int j = start - column;
+		vec2 d = cap_direction(j, start, normal(tangent[0]), -tangent[0]);
+
+		gl_Position = vec4(in_data[0].pos + gl_TessCoord.y * abs(in_data[0].width) * d, 0, 1);
+		stroke = vec4(in_data[0].color, in_data[0].distance);
+
+		return;
+	}
+
+	if (column > first + n)
+	{
+		int j = column - first - n - 1;
+		vec2 d = tangent[1] == tangent[2] ? cap_direction(j, end, normal(tangent[1]), tangent[1]) : join_direction(j, end, tangent[1], tangent[2]);
+
+		gl_Position = vec4(in_data[3].pos + gl_TessCoord.y * abs(in_data[3].width) * d, 0, 1);
+		stroke = vec4(in_data[3].color, distance_at(1.0));
+
+		return;
+	}
+
+	float x = float(column - first) / n;
+
+	VertexAttrib v = vertexMix(x);
+
+	vec2 t = tangent_at(x);
 
-	vec2 t = tangent();
+	// A retracted handle leaves no derivative at its end, where the control shader's tangents still have the direction.
+	if (dot(t, t) == 0.0)
+		t = x < 0.5 ? tangent[0] : tangent[1];
 
 	// There's multiple ways to combine these values for different effects, for example:
 	// Remove the normalize and the line will get wider as it moves quicker.
 	// Dynamically change the gl_TessCoord.y factor to dynamically change how the line is centered.
 	// Mix an attribute with other functions of gl_TessCoord.x.
 
-	vec2 n = v.width*(2*gl_TessCoord.y-1)*normalize(vec2(-t.y,t.x));
+	vec2 offset = v.width*(2*gl_TessCoord.y-1)*normalize(normal(t));
 
-	gl_Position = vec4(v.pos+n,0,1);
-	color = v.color;
+	gl_Position = vec4(v.pos+offset,0,1);
+	stroke = vec4(v.color, distance_at(x));
 }
\ No newline at end of file
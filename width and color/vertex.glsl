@@ -7,12 +7,14 @@
 layout(location = 0) in vec2 pos;
 layout(location = 1) in float width;
 layout(location = 2) in vec3 color;
+layout(location = 3) in float distance;
 
 layout(location = 0) out struct VertexAttrib
 {
 	vec2 pos;
 	float width;
 	vec3 color;
+	float distance;
 } out_data;
 
 void main()
@@ -20,4 +22,5 @@ void main()
 	out_data.pos = pos;
 	out_data.width = width;
 	out_data.color = color;
+	out_data.distance = distance;
 }
\ No newline at end of file